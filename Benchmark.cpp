@@ -0,0 +1,310 @@
+// tick throughput benchmark over generated reference circuits
+// like the rest of combiler it builds with msvc only (c++17, zlib), the header relies on its token pasting and anonymous structs
+// prints one json object per line and circuit size, so that results of different versions can be compared by scripts
+// usage: Benchmark [generator name] [largest size] [seconds per simulation mode] [most threads]
+// the parallel mode is measured for every power of two up to the most threads, which default to the hardware threads. Thread
+// counts above hardwareThreads only measure the cost of oversubscribing the cores, not scaling
+// batch counts the ticks of all lanes, kernel is the time to emit the kernel source, which this benchmark doesn't compile
+// replayAgrees checks that the interpreted mode and the frozen program give the same main outputs from the first tick on, with and
+// without constant folding, and foldingAgrees that folding doesn't change them after the transient. The exit code is 1 if any check fails
+// peak resident memory is that of the whole process up to the point of measuring, so sizes should be benchmarked in increasing order
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include "Combiler.hpp"
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace virtualSignal;
+using clock_type = std::chrono::steady_clock;
+
+size_t peakResidentBytes()
+{
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+  return counters.PeakWorkingSetSize;
+#else
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return static_cast<size_t>(usage.ru_maxrss);
+#else
+  return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+double secondsSince(clock_type::time_point const& start)
+{
+  return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+// forgets the previous circuit by swapping it into a temporary circuit, which destroys it
+void resetCircuit()
+{
+  circuit().bind();
+}
+
+signal const& itemAt(size_t i) { return itemSignal::itemSignals[i % itemSignal::itemSignalCount]; }
+
+// constant combinators holding the n first signals with the values 1 to n, 18 signals per combinator
+connector<color::r> constants(size_t n)
+{
+  connector<color::r> result = conCom<color::r>{ { itemAt(0) = 1 } };
+  for (size_t i = 1; i < n; i += 18)
+  {
+    conComData data = {};
+    for (size_t j = 0; j < 18 && i + j < n; j++)
+      data[j] = itemAt(i + j) = static_cast<int32_t>(i + j + 1);
+    result += conCom<color::r>{ data };
+  }
+  return result;
+}
+
+// a loop wire carrying n signals, which every each combinator on it processes at once
+void wideBus(size_t n)
+{
+  auto bus = wire<color::r>::loop();
+  connector<color::r> next = constants(n);
+  next += bus > (each > 100000 then each += 1).r;
+  next += bus > ((each % 100000) on each).r;
+  bus <<= next;
+  wire<color::r> sum = bus > ((each + 0) on A).r;
+  wire<color::r> filtered = bus > (each < 50000 then each += input).r;
+  sum.markAsOutput();
+  filtered.markAsOutput();
+}
+
+// n counters, each of which counts up once per overflow of the previous one
+void counterChain(size_t n)
+{
+  auto first = wire<color::r>::loop();
+  first <<= conCom<color::r>{ { A = 1 } } += first > (A < 10 then A += input).r;
+  wire<color::r> previous = first;
+  for (size_t i = 1; i < n; i++)
+  {
+    auto counter = wire<color::r>::loop();
+    counter <<= previous > (A == 9 then A += 1).r += counter > (A < 10 then A += input).r;
+    previous = counter;
+  }
+  previous.markAsOutput();
+}
+
+// n set/reset latches, which are set and reset by a shared timer at different times
+void latchArray(size_t n)
+{
+  auto timer = wire<color::g>::loop();
+  timer <<= conCom<color::g>{ { T = 1 } } += timer > (T < 100 then T += input).g;
+  for (size_t i = 0; i < n; i++)
+  {
+    auto latch = wire<color::r>::loop();
+    connector<color::g> control = timer > (T == static_cast<int32_t>(i % 100) then S += 1).g;
+    control += timer > (T == static_cast<int32_t>((i + 50) % 100) then R += 1).g;
+    latch <<= (latch + wire<color::g>(control)) >> (S > R then S += 1).r;
+    latch.markAsOutput();
+  }
+}
+
+// sums n constants through a binary tree of arithmetic combinators
+void adderTree(size_t n)
+{
+  std::vector<connector<color::r>> level;
+  for (size_t i = 0; i < n; i++)
+    level.push_back(conCom<color::r>{ { A = static_cast<int32_t>(i + 1), itemAt(i) = 1 } });
+  while (level.size() > 1)
+  {
+    std::vector<connector<color::r>> next;
+    for (size_t i = 0; i + 1 < level.size(); i += 2)
+    {
+      wire<color::r> both = level[i] += level[i + 1];
+      next.push_back(both > ((each + 0) on each).r);
+    }
+    if (level.size() % 2 == 1)
+      next.push_back(level.back());
+    level = next;
+  }
+  wire<color::r> result = level.front();
+  result.markAsOutput();
+}
+
+// a ring of n arithmetic combinators that passes a growing value around
+void feedbackRing(size_t n)
+{
+  std::vector<wire<color::r>> ring;
+  for (size_t i = 0; i < n; i++)
+    ring.push_back(wire<color::r>::loop());
+  for (size_t i = 0; i < n; i++)
+    ring[(i + 1) % n] <<= i == 0 ? ring[i] > ((A % 1000000) on A).r : ring[i] > ((A + 1) on A).r;
+  ring.front().markAsOutput();
+}
+
+struct generator
+{
+  char const* name;
+  std::function<void(size_t)> build;
+  size_t firstSize;
+};
+
+// values of the main outputs during the given number of ticks after the first skipped ticks, networks separated by -1
+// replaying reruns the circuit code every tick like the interpreted mode does, otherwise the frozen program is run
+std::vector<int64_t> outputTrace(generator const& gen, size_t n, uint64_t skipped, uint64_t ticks, bool replay)
+{
+  resetCircuit();
+  gen.build(n);
+  std::vector<size_t> outputs;
+  for (network const& net : network::list)
+    if (net.flags & network::isMainOutput)
+      outputs.push_back(net.id);
+  compileFirstOrSimulate(2);
+  program prog = program::freeze();
+  std::vector<int64_t> trace;
+  for (uint64_t tick = 0; tick < skipped + ticks; tick++)
+  {
+    if (replay)
+    {
+      gen.build(n);
+      compileFirstOrSimulate(2);
+    }
+    else
+      prog.run(1);
+    if (tick >= skipped)
+      for (size_t id : outputs)
+      {
+        network::list[network::indexOf(id)].lastValues->forEach([&trace](size_t slot, int32_t value) { trace.push_back(int64_t(slot) << 32 | static_cast<uint32_t>(value)); });
+        trace.push_back(-1);
+      }
+  }
+  return trace;
+}
+
+// the interpreted mode has to simulate what the frozen program simulates from the first tick on, with and without constant folding
+bool replayAgrees(generator const& gen, size_t n)
+{
+  bool const enabled = constantFolding::enabled;
+  bool agrees = true;
+  for (bool folding : { false, true })
+  {
+    constantFolding::enabled = folding;
+    agrees = agrees && outputTrace(gen, n, 0, 200, true) == outputTrace(gen, n, 0, 200, false);
+  }
+  constantFolding::enabled = enabled;
+  return agrees;
+}
+
+// folded networks hold their final values from the first tick on, so constant folding can only shorten the transient, which
+// 200 ticks are enough for with all generators
+bool foldingAgrees(generator const& gen, size_t n)
+{
+  bool const enabled = constantFolding::enabled;
+  constantFolding::enabled = false;
+  std::vector<int64_t> unfolded = outputTrace(gen, n, 200, 200, false);
+  constantFolding::enabled = true;
+  std::vector<int64_t> folded = outputTrace(gen, n, 200, 200, false);
+  constantFolding::enabled = enabled;
+  return folded == unfolded;
+}
+
+// runs simulate until at least the given time has passed and returns the achieved ticks per second
+double ticksPerSecond(double seconds, std::function<void(uint64_t)> const& simulate)
+{
+  uint64_t ticks = 0;
+  auto start = clock_type::now();
+  for (uint64_t batch = 1; secondsSince(start) < seconds; batch *= 2)
+  {
+    simulate(batch);
+    ticks += batch;
+  }
+  return ticks / secondsSince(start);
+}
+
+int main(int argc, char** argv)
+{
+  std::string only = argc > 1 ? argv[1] : "";
+  size_t largest = argc > 2 ? std::stoul(argv[2]) : 1024;
+  double seconds = argc > 3 ? std::stod(argv[3]) : 0.5;
+  size_t mostThreads = argc > 4 ? std::stoul(argv[4]) : std::max<size_t>(1, std::thread::hardware_concurrency());
+  uint16_t constexpr lengthOfValueHistory = 2;
+  size_t constexpr batchLanes = 8;
+
+  int result = 0;
+  std::vector<generator> generators = {
+    { "wideBus",      wideBus,      16 },
+    { "counterChain", counterChain, 4 },
+    { "latchArray",   latchArray,   4 },
+    { "adderTree",    adderTree,    4 },
+    { "feedbackRing", feedbackRing, 4 },
+  };
+  for (generator const& gen : generators)
+    if (only.empty() || only == gen.name)
+      for (size_t n = gen.firstSize; n <= largest; n *= 4)
+      {
+        resetCircuit();
+        auto start = clock_type::now();
+        gen.build(n);
+        double buildSeconds = secondsSince(start);
+
+        start = clock_type::now();
+        std::string blueprint = compileFirstOrSimulate(lengthOfValueHistory);
+        double compileSeconds = secondsSince(start);
+        size_t combinators = network::source::list.size(), networks = network::list.size();
+
+        double interpreted = ticksPerSecond(seconds, [&](uint64_t ticks)
+        {
+          for (; ticks != 0; ticks--)
+          {
+            gen.build(n);
+            compileFirstOrSimulate(lengthOfValueHistory);
+          }
+        });
+        program prog = program::freeze();
+        double tape = ticksPerSecond(seconds, [&](uint64_t ticks) { prog.run(ticks); });
+        double eventDriven = ticksPerSecond(seconds, [&](uint64_t ticks) { prog.runEventDriven(ticks); });
+        batch lanes(prog, batchLanes);
+        double batched = batchLanes * ticksPerSecond(seconds, [&](uint64_t ticks) { lanes.run(ticks); });
+        std::vector<std::pair<size_t, double>> parallel;
+        for (size_t threads = 1; threads <= mostThreads; threads *= 2)
+          parallel.emplace_back(threads, ticksPerSecond(seconds, [&](uint64_t ticks) { prog.runParallel(ticks, threads); }));
+
+        start = clock_type::now();
+        std::string kernel = emitKernel();
+        double kernelSeconds = secondsSince(start);
+        size_t peak = peakResidentBytes();
+        bool replayed = replayAgrees(gen, n), folded = foldingAgrees(gen, n);
+        if (!replayed || !folded)
+          result = 1;
+
+        std::cout << "{\"generator\":\"" << gen.name << "\",\"n\":" << n
+                  << ",\"combinators\":" << combinators
+                  << ",\"networks\":" << networks
+                  << ",\"hardwareThreads\":" << std::thread::hardware_concurrency()
+                  << ",\"buildSeconds\":" << buildSeconds
+                  << ",\"compileSeconds\":" << compileSeconds
+                  << ",\"blueprintBytes\":" << blueprint.size()
+                  << ",\"kernelSeconds\":" << kernelSeconds
+                  << ",\"kernelBytes\":" << kernel.size()
+                  << ",\"ticksPerSecond\":{\"interpreted\":" << interpreted << ",\"tape\":" << tape << ",\"eventDriven\":" << eventDriven << ",\"batch\":" << batched
+                  << ",\"parallel\":{";
+        for (size_t i = 0; i < parallel.size(); i++)
+          std::cout << (i == 0 ? "" : ",") << "\"" << parallel[i].first << "\":" << parallel[i].second;
+        std::cout << "}}"
+                  << ",\"peakResidentBytes\":" << peak
+                  << ",\"replayAgrees\":" << (replayed ? "true" : "false")
+                  << ",\"foldingAgrees\":" << (folded ? "true" : "false") << "}" << std::endl;
+      }
+  return result;
+}
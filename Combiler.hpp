@@ -6,6 +6,7 @@
 #include <optional>
 #include <vector>
 #include <array>
+#include <memory>
 
 
 struct All;
@@ -200,6 +201,7 @@ struct signal
     std::string gameSyntax;
     std::string type;
     size_t index;
+    size_t slot; // index into the dense value store, shared between items, fluids and virtual signals
     EqualityOperatorsDecl(Description);
   } const* description;
 
@@ -747,13 +749,18 @@ namespace itemSignal
   op(personal_roboport_equipment) op(personal_roboport_mk2_equipment) op(night_vision_equipment)                                                                                                                                                                                                                                 \
   op(stone_wall)                  op(gate)                            op(gun_turret)              op(laser_turret)                op(flamethrower_turret)    op(artillery_turret)      op(radar) op(rocket_silo)
 
+  size_t constexpr itemSignalCount = 0
+#define op(name) + 1
+    operations
+#undef op
+    ;
 
   std::vector<signal> const itemSignals = ([]() {
     size_t i = 0;
     auto toGameCode = [](std::string s){ std::replace(s.begin(), s.end(), '_', '-'); return s; };
     return std::vector<signal>{
 #define op(name) \
-    signal{new signal::Description{#name, toGameCode(#name), "item", i++}},
+    signal{new signal::Description{#name, toGameCode(#name), "item", i, i++}},
     operations
 #undef op
   }; })();
@@ -776,12 +783,18 @@ namespace fluidSignal
 #define operations \
   op(water)  op(crude_oil)  op(heavy_oil)  op(light_oil)  op(petroleum_gas)  op(sulfuric_acid)  op(lubricant)
 
+  size_t constexpr fluidSignalCount = 0
+#define op(name) + 1
+    operations
+#undef op
+    ;
+
   std::vector<signal> const fluidSignals = ([]() {
     size_t i = 0;
     auto toGameCode = [](std::string s) { std::replace(s.begin(), s.end(), '_', '-'); return s; };
     return std::vector<signal>{
 #define op(name) \
-    signal{new signal::Description{#name, toGameCode(#name), "fluid", i++}},
+    signal{new signal::Description{#name, toGameCode(#name), "fluid", i, itemSignal::itemSignalCount + i++}},
       operations
 #undef op
   }; })();
@@ -808,12 +821,18 @@ namespace virtualSignal
   op(red,) op(green,) op(blue,) op(yellow,) op(pink,) op(cyan,) op(white,) op(grey,) op(black,)       \
   op(check,) op(dot,) op(info,)
 
+  size_t constexpr virtualSignalCount = 0
+#define op(name, score) + 1
+    operations
+#undef op
+    ;
+
   std::vector<signal> const virtualSignals = ([]() {
     size_t i = 0;
     auto toGameCode = [](std::string s) { std::replace(s.begin(), s.end(), '_', '-'); return s; };
     return std::vector<signal>{
 #define op(name, score) \
-    signal{new signal::Description{#score#name, "signal-"#name, "virtual", i++}},
+    signal{new signal::Description{#score#name, "signal-"#name, "virtual", i, itemSignal::itemSignalCount + fluidSignal::fluidSignalCount + i++}},
       operations
 #undef op
   }; })();
@@ -831,7 +850,36 @@ namespace virtualSignal
 #undef operations
 }
 
+// compiling throws std::runtime_error when the entities are packed too densely to wire every network within reach
 std::string compileFirstOrSimulate(uint16_t lengthOfValueHistory);
+// adds the combinators of a blueprint string, as exported by the game or by compile(), to the current circuit instead of running circuit code
+// the circuit is then compiled with compileFirstOrSimulate() once and simulated with program::freeze()
+void importBlueprint(std::string const& blueprint);
+std::string emitKernel(std::string const& name = "circuit");
+
+// the state of one circuit: its networks, sources and entities and everything compile() and the simulation derive from them
+// the circuit code, compile() and the simulation work on the current circuit of their thread. bind() swaps it with the circuit
+// held by this object, so that one process can keep many circuits and build, compile and simulate them on different threads
+// the options of the compiler passes, like constantFolding::enabled, are shared by all circuits
+struct circuit
+{
+  circuit();
+  circuit(circuit&&) noexcept;
+  circuit& operator=(circuit&&) noexcept;
+  ~circuit();
+  void bind(); // binding the same circuit again swaps the previous one back
+
+  // binds a circuit for the lifetime of the scope
+  struct scope
+  {
+    circuit& bound;
+    scope(circuit& c) : bound(c) { c.bind(); }
+    ~scope() { this->bound.bind(); }
+  };
+private:
+  struct state;
+  std::unique_ptr<state> data;
+};
 #ifndef COMBILER_IMPLEMENTATION
 #undef ariOperations
 #undef deciOperations
@@ -855,8 +903,29 @@ std::string compileFirstOrSimulate(uint16_t lengthOfValueHistory);
 
 #ifdef COMBILER_IMPLEMENTATION
 #include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <charconv>
+#include <cctype>
+#include <string_view>
 #include <cassert>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <unordered_map>
 #include "zlib.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define COMBILER_SIMD
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COMBILER_SIMD
+#endif
 
 template <class ...Fs>
 struct overload : Fs... {
@@ -1191,21 +1260,160 @@ autoOperators(ariComData::Input::Right, ariComData::Output, op)
 
 #define setFlag(var, flag) var = static_cast<decltype(var)>(var | flag)
 
+#ifdef _MSC_VER
+inline size_t lowestBit(uint64_t word) { unsigned long i; _BitScanForward64(&i, word); return i; }
+inline size_t popCount(uint64_t word) { return static_cast<size_t>(__popcnt64(word)); }
+#else
+inline size_t lowestBit(uint64_t word) { return static_cast<size_t>(__builtin_ctzll(word)); }
+inline size_t popCount(uint64_t word) { return static_cast<size_t>(__builtin_popcountll(word)); }
+#endif
+// signed overflow wraps around ingame
+inline int32_t wrappingAdd(int32_t left, int32_t right) { return static_cast<int32_t>(static_cast<uint32_t>(left) + static_cast<uint32_t>(right)); }
+
+// values of all signals on a network, indexed by signal::Description::slot
+// a signal is present if and only if its value is non zero, which is tracked in a bitmap to make iteration cheap
+struct signalValues
+{
+  static size_t constexpr size = itemSignal::itemSignalCount + fluidSignal::fluidSignalCount + virtualSignal::virtualSignalCount;
+  static size_t constexpr words = (size + 63) / 64;
+  static signal const& signalAt(size_t slot)
+  {
+    if (slot < itemSignal::itemSignalCount)
+      return itemSignal::itemSignals[slot];
+    if ((slot -= itemSignal::itemSignalCount) < fluidSignal::fluidSignalCount)
+      return fluidSignal::fluidSignals[slot];
+    return virtualSignal::virtualSignals[slot - fluidSignal::fluidSignalCount];
+  }
+
+  using bits = std::array<uint64_t, words>;
+  bits present = {};
+  std::array<int32_t, words * 64> values = {}; // padded to whole bitmap words, so that vector kernels can always process full words
+
+  struct iterator
+  {
+    signalValues const* sv;
+    size_t word;
+    uint64_t bits;
+
+    signal::WithValue operator*() const { size_t slot = this->word * 64 + lowestBit(this->bits); return { this->sv->values[slot], signalAt(slot) }; }
+    iterator& operator++()
+    {
+      this->bits &= this->bits - 1;
+      while (this->bits == 0 && ++this->word < words)
+        this->bits = this->sv->present[this->word];
+      return *this;
+    }
+    bool operator!=(iterator const& o) const { return this->word != o.word || this->bits != o.bits; }
+  };
+  iterator begin() const
+  {
+    iterator it{ this, 0, this->present[0] };
+    while (it.bits == 0 && ++it.word < words)
+      it.bits = this->present[it.word];
+    return it;
+  }
+  iterator end() const { return { this, words, 0 }; }
+
+  template<class F> void forEach(F const& f) const // calls f(slot, value) for every present signal
+  {
+    for (size_t w = 0; w < words; w++)
+      for (uint64_t bits = this->present[w]; bits; bits &= bits - 1)
+      {
+        size_t slot = w * 64 + lowestBit(bits);
+        f(slot, this->values[slot]);
+      }
+  }
+
+  int32_t operator[](signal const& s) const { return this->values[s.description->slot]; }
+  int32_t operator[](size_t const& slot) const { return this->values[slot]; }
+  bool empty() const
+  {
+    for (uint64_t w : this->present)
+      if (w != 0)
+        return false;
+    return true;
+  }
+  void add(size_t slot, int32_t value)
+  {
+    if (value == 0)
+      return;
+    int32_t& v = this->values[slot];
+    v = wrappingAdd(v, value);
+    if (v == 0)
+      this->present[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+    else
+      this->present[slot / 64] |= uint64_t(1) << (slot % 64);
+  }
+  void add(signal::WithValue const& sv) { this->add(sv.sig.description->slot, sv.value); }
+  signalValues& operator+=(signalValues const& o)
+  {
+    o.forEach([this](size_t slot, int32_t value) { this->add(slot, value); });
+    return *this;
+  }
+  void clear()
+  {
+    this->forEach([this](size_t slot, int32_t) { this->values[slot] = 0; });
+    this->present = {};
+  }
+  void keepOnly(bits const& mask) // removes the signals that aren't in mask
+  {
+    for (size_t w = 0; w < words; w++)
+    {
+      for (uint64_t dropped = this->present[w] & ~mask[w]; dropped; dropped &= dropped - 1)
+        this->values[w * 64 + lowestBit(dropped)] = 0;
+      this->present[w] &= mask[w];
+    }
+  }
+  size_t count() const // number of present signals
+  {
+    size_t result = 0;
+    for (uint64_t w : this->present)
+      result += popCount(w);
+    return result;
+  }
+  bool operator==(signalValues const& o) const { return this->present == o.present && this->values == o.values; }
+  bool operator!=(signalValues const& o) const { return !(*this == o); }
+};
+
+// calls f(slot, value) for every signal present on the sum of both (possibly missing) inputs
+template<class F> void forEachInput(signalValues const* red, signalValues const* green, F const& f)
+{
+  if (red == nullptr || green == nullptr)
+  {
+    if (red != nullptr || green != nullptr)
+      (red != nullptr ? red : green)->forEach(f);
+    return;
+  }
+  for (size_t w = 0; w < signalValues::words; w++)
+    for (uint64_t bits = red->present[w] | green->present[w]; bits; bits &= bits - 1)
+    {
+      size_t slot = w * 64 + lowestBit(bits);
+      if (int32_t value = wrappingAdd(red->values[slot], green->values[slot]))
+        f(slot, value);
+    }
+}
+
 struct entity;
 struct network
 {
   struct source
   {
-    static std::vector<source> list;
+    static thread_local std::vector<source> list;
     enum {
       none             = 0b0000,
       isConCom         = 0b0001,
       isDeciCom        = 0b0010,
       isAriCom         = 0b0100,
       isDeciOrAri      = 0b0110,
-      isOutputRelevant = 0b1000
+      isOutputRelevant = 0b1000,
+      isDuplicate      = 0b10000,  // replaced by an identical source, so the circuit code doesn't simulate it anymore
+      isEliminated     = 0b100000, // removed from its network by a compiler pass, so the circuit code doesn't simulate it anymore
+      isRewritten      = 0b1000000 // changed by a compiler pass, so the circuit code simulates the stored source instead of its own
     } flags;
     pointer<entity> entity;
+    // specialization for the mode and operand kinds of a decider or arithmetic combinator, which adds its output for the given inputs to out
+    using evaluator = void(*)(source const&, signalValues const* red, signalValues const* green, signalValues& out);
+    evaluator evaluate = nullptr;
     union
     {
       conComData cCombinator = {};
@@ -1233,16 +1441,36 @@ struct network
         [](wire<color::g> const& g) { return std::make_tuple(pointer<network>(nullptr), g.source.source); },
         [](wire<color::rg> const& rg) { return std::make_tuple(rg.r.source.source, rg.g.source.source); }
       ), source);
+      this->resolve();
     }
+    void resolve();
+    void simulate(network& out, network* second = nullptr) const; // adds the output of this tick to out and second
 
     template <color c>
     connector<c> getConnector() const;
   };
-  static std::vector<network> list;
-  static std::vector<size_t> lookup;
+  static thread_local std::vector<network> list;
+  // a pointer<network> holds a network id. Merged networks share a tree of the union-find forest parent, whose root is
+  // the id of the network and the index into lookup, which holds its position in list
+  static thread_local std::vector<size_t> parent;
+  static thread_local std::vector<size_t> lookup;
+  static size_t find(size_t id)
+  {
+    while (network::parent[id] != id)
+      id = network::parent[id] = network::parent[network::parent[id]]; // path halving
+    return id;
+  }
+  static size_t indexOf(size_t id) { return network::lookup[network::find(id)]; }
+  static size_t newId() // of a network about to be appended to list
+  {
+    network::parent.emplace_back(network::parent.size());
+    network::lookup.emplace_back(network::list.size());
+    return network::parent.size() - 1;
+  }
+  static void compact(); // points every id directly at its root, which makes find() a single step
 
   std::vector<pointer<source>> sources;
-  std::vector<size_t> inverseLookup; // contains i if and only if this == network::list[network::lookup[i]]
+  size_t id; // root of all ids of this network
   std::vector<pointer<source>> targets;
   color c;
   enum : uint8_t {
@@ -1250,13 +1478,17 @@ struct network
     isCompleted      = 0b0001,
     isLoop           = 0b0010,
     isOutputRelevant = 0b0100,
-    isMainOutput     = 0b1000
+    isMainOutput     = 0b1000,
+    hasDeadSignals   = 0b10000 // can carry signals outside of live, which are dropped when a tick is complete
   } flags;
+  size_t ids = 1; // number of ids in the tree of id, which decides which of two merged trees becomes the root
 
-  static size_t simIndex, lookupIndex;
-  std::vector<std::vector<signal::WithValue>> values = { {} };
-  std::vector<signal::WithValue>* lastValues = nullptr;
-  std::vector<signal::WithValue>* nextValues = &values[0];
+  static thread_local size_t simIndex, lookupIndex;
+  static thread_local size_t sourceIndex; // index into source::list of the next source the circuit code creates while simulating
+  std::vector<signalValues> values = { {} };
+  signalValues* lastValues = nullptr;
+  signalValues* nextValues = &values[0];
+  signalValues::bits live = {}; // signals that can influence a main output, see liveness
 
   void markAsOutput() { setFlag(this->flags, isMainOutput); }
   network& operator+=(network& other)
@@ -1265,8 +1497,6 @@ struct network
       return other;
     assert(this->c == other.c && "cannot merge networks with different colors!");
     assert(this != &other && "cannot merge a network with itself!");
-    assert(this->inverseLookup.size() >= 1 && "internal error. Network somehow doesn't have an index.");
-    assert(other.inverseLookup.size() >= 1 && "internal error. Network somehow doesn't have an index.");
     if (this->flags & network::isLoop)
     {
       // merge connector this into loop wire other
@@ -1286,18 +1516,29 @@ struct network
       assert(this->targets.size() == 0 && "internal error. Connector somehow contains target information.");
       assert(other.targets.size() == 0 && "internal error. Connector somehow contains target information.");
 
+      // append the shorter list, so that a bus joined one connector at a time doesn't copy itself every time
+      if (this->sources.size() > other.sources.size())
+        std::swap(this->sources, other.sources);
       other.sources.insert(other.sources.end(), std::make_move_iterator(this->sources.begin()), std::make_move_iterator(this->sources.end()));
     }
-    size_t oldLookup = network::lookup[this->inverseLookup[0]];
-    for (auto il : this->inverseLookup)
-      network::lookup[il] = network::lookup[other.inverseLookup[0]];
-    other.inverseLookup.insert(other.inverseLookup.end(), std::make_move_iterator(this->inverseLookup.begin()), std::make_move_iterator(this->inverseLookup.end()));
+    return this->redirectTo(other);
+  }
+  // makes all pointers to this network point to other and removes this network from network::list
+  network& redirectTo(network& other)
+  {
+    size_t oldLookup = network::lookup[this->id];
+    size_t position = network::lookup[other.id];
+    // union by size keeps the trees flat
+    if (this->ids > other.ids)
+      std::swap(this->id, other.id);
+    network::parent[this->id] = other.id;
+    network::lookup[other.id] = position;
+    other.ids += this->ids;
 
     setFlag(other.flags, this->flags);
     if (oldLookup != network::list.size() - 1)
     {
-      for (auto ref : network::list.back().inverseLookup)
-        network::lookup[ref] = oldLookup;
+      network::lookup[network::list.back().id] = oldLookup;
       std::swap(network::list.back(), *this);
     }
     network::list.pop_back();
@@ -1306,11 +1547,10 @@ struct network
 
   void simulate(signal::WithValue const&);
   void simulate(conComData const&);
-  void simulate(ariComData const&, std::vector<signal::WithValue> const&);
-  void simulate(deciComData const&, std::vector<signal::WithValue> const&);
 };
-size_t network::simIndex = 0;
-size_t network::lookupIndex = 0;
+thread_local size_t network::simIndex = 0;
+thread_local size_t network::lookupIndex = 0;
+thread_local size_t network::sourceIndex = 0;
 
 template<color c> void wire<c>::markAsOutput() const { this->network().markAsOutput(); }
 template<color c> wire<c>::wire(connector<c> const& source) : source(source) 
@@ -1321,34 +1561,111 @@ template<color c> wire<c>::wire(connector<c> const& source) : source(source)
 template<class T>
 T* pointer<T>::operator->() const { return this->index == -1 ? nullptr : &T::list[this->index]; }
 template<>
-network* pointer<network>::operator->() const { return this->index == -1 ? nullptr : &network::list[network::lookup[this->index]]; }
+network* pointer<network>::operator->() const { return this->index == -1 ? nullptr : &network::list[network::indexOf(this->index)]; }
 
-std::vector<network> network::list;
-std::vector<size_t> network::lookup;
-std::vector<network::source> network::source::list;
+thread_local std::vector<network> network::list;
+thread_local std::vector<size_t> network::parent;
+thread_local std::vector<size_t> network::lookup;
+void network::compact()
+{
+  for (size_t id = 0; id < network::parent.size(); id++)
+    network::parent[id] = network::find(id);
+}
 
-std::vector<signal::WithValue> operator+(pointer<network> const& red, pointer<network> const& green)
+// the circuit as compressed sparse rows of 32 bit indices into network::list and network::source::list, which compile()
+// freezes once the circuit code is done and again after every pass that changes the circuit. Everything after the build
+// traverses these arrays instead of following pointer<network> through network::lookup
+struct graph
 {
-  if (red == nullptr)
-    return *green->lastValues;
-  if (green == nullptr)
-    return *red->lastValues;
+  static uint32_t constexpr none = UINT32_MAX;
+  struct rows
+  {
+    struct row
+    {
+      uint32_t const* first;
+      uint32_t const* last;
+      uint32_t const* begin() const { return this->first; }
+      uint32_t const* end() const { return this->last; }
+      size_t size() const { return this->last - this->first; }
+    };
+    std::vector<uint32_t> start; // row r is index[start[r]] up to index[start[r + 1]]
+    std::vector<uint32_t> index;
+    row operator[](size_t r) const { return { this->index.data() + this->start[r], this->index.data() + this->start[r + 1] }; }
+  };
+  static thread_local rows writers; // sources writing into every network
+  static thread_local rows readers; // decider and arithmetic combinators reading every network
+  static thread_local rows outputs; // networks every source writes into
+  static thread_local std::vector<uint32_t> red, green; // input networks of every source or none
+  static thread_local std::vector<uint32_t> networkOf;  // position in network::list of every network id
 
-  std::vector<signal::WithValue> sum = *red->lastValues;
-  for (auto sv : *green->lastValues)
+  static void freeze();
+};
+thread_local graph::rows graph::writers;
+thread_local graph::rows graph::readers;
+thread_local graph::rows graph::outputs;
+thread_local std::vector<uint32_t> graph::red;
+thread_local std::vector<uint32_t> graph::green;
+thread_local std::vector<uint32_t> graph::networkOf;
+
+void graph::freeze()
+{
+  size_t networks = network::list.size(), sources = network::source::list.size();
+  assert(networks < none && sources < none && network::parent.size() < none && "circuit too large for 32 bit indices!");
+  networkOf.resize(network::parent.size());
+  for (size_t id = 0; id < network::parent.size(); id++)
+    networkOf[id] = static_cast<uint32_t>(network::indexOf(id));
+
+  writers.start.assign(1, 0);
+  writers.index.clear();
+  for (network const& net : network::list)
   {
-    bool newSig = true;
-    for (signal::WithValue& nsv : sum)
-      if (sv.sig == nsv.sig)
-      {
-        nsv.value += sv.value;
-        newSig = false;
-        break;
-      }
-    if (newSig)
-      sum.push_back(sv);
+    for (pointer<network::source> const& ps : net.sources)
+      writers.index.push_back(static_cast<uint32_t>(ps.index));
+    writers.start.push_back(static_cast<uint32_t>(writers.index.size()));
   }
-  return sum;
+  red.assign(sources, none);
+  green.assign(sources, none);
+  for (size_t s = 0; s < sources; s++)
+  {
+    network::source const& source = network::source::list[s];
+    if (!(source.flags & network::source::isDeciOrAri))
+      continue;
+    if (source.redInput.index != -1)
+      red[s] = networkOf[source.redInput.index];
+    if (source.greenInput.index != -1)
+      green[s] = networkOf[source.greenInput.index];
+  }
+
+  // the transposed rows, by counting the entries of every row first
+  auto transpose = [](size_t count, auto const& forEach, rows& result)
+  {
+    result.start.assign(count + 1, 0);
+    forEach([&result](uint32_t r, uint32_t) { result.start[r + 1]++; });
+    for (size_t r = 0; r < count; r++)
+      result.start[r + 1] += result.start[r];
+    result.index.resize(result.start[count]);
+    std::vector<uint32_t> next(result.start.begin(), result.start.end() - 1);
+    forEach([&result, &next](uint32_t r, uint32_t entry) { result.index[next[r]++] = entry; });
+  };
+  transpose(sources, [networks](auto const& f)
+  {
+    for (uint32_t n = 0; n < networks; n++)
+      for (uint32_t s : writers[n])
+        f(s, n);
+  }, outputs);
+  transpose(networks, [sources](auto const& f)
+  {
+    for (uint32_t s = 0; s < sources; s++)
+      for (uint32_t in : { red[s], green[s] })
+        if (in != none)
+          f(in, s);
+  }, readers);
+}
+thread_local std::vector<network::source> network::source::list;
+
+signalValues const* lastValuesOf(pointer<network> const& net) // while simulating, after graph::freeze()
+{
+  return net.index == -1 ? nullptr : network::list[graph::networkOf[net.index]].lastValues;
 }
 
 template<color c>
@@ -1364,20 +1681,17 @@ connector<c> network::source::getConnector() const
         this->greenInput->targets.emplace_back(network::source::list.size());
     }
 
-    network::list.emplace_back(network{ { pointer<network::source>{ network::source::list.size() } }, { network::lookup.size() }, {}, c, network::none });
-    network::lookup.emplace_back(network::list.size() - 1);
+    network::list.emplace_back(network{ { pointer<network::source>{ network::source::list.size() } }, network::newId(), {}, c, network::none });
 
     network::source::list.emplace_back(*this);
     return connector<c>(pointer<network>{ network::lookup.size() - 1 });
   }
   else
   {
-    switch (this->flags & (network::source::isDeciOrAri | network::source::isConCom))
-    {
-    case network::source::isConCom:  network::list[network::lookup[network::lookupIndex]].simulate(this->cCombinator); break;
-    case network::source::isAriCom:  network::list[network::lookup[network::lookupIndex]].simulate(this->aCombinator, this->redInput + this->greenInput); break;
-    case network::source::isDeciCom: network::list[network::lookup[network::lookupIndex]].simulate(this->dCombinator, this->redInput + this->greenInput); break;
-    }
+    assert(network::sourceIndex < network::source::list.size() && "the circuit code created more sources than while building it!");
+    network::source const& stored = network::source::list[network::sourceIndex++];
+    if (!(stored.flags & (network::source::isDuplicate | network::source::isEliminated)))
+      (stored.flags & network::source::isRewritten ? stored : *this).simulate(network::list[graph::networkOf[network::lookupIndex]]);
     return connector<c>(pointer<network>{ network::lookupIndex++ });
   }
 }
@@ -1394,12 +1708,10 @@ connector<color::rg> network::source::getConnector() const
         this->greenInput->targets.emplace_back(network::source::list.size());
     }
 
-    network::list.emplace_back(network{ { pointer<network::source>{ network::source::list.size() } }, { network::lookup.size() }, {}, color::r, network::none });
-    network::lookup.emplace_back(network::list.size() - 1);
+    network::list.emplace_back(network{ { pointer<network::source>{ network::source::list.size() } }, network::newId(), {}, color::r, network::none });
     connector<color::r> r(pointer<network>{ network::lookup.size() - 1 });
 
-    network::list.emplace_back(network{ { pointer<network::source>{ network::source::list.size() } }, { network::lookup.size() }, {}, color::g, network::none });
-    network::lookup.emplace_back(network::list.size() - 1);
+    network::list.emplace_back(network{ { pointer<network::source>{ network::source::list.size() } }, network::newId(), {}, color::g, network::none });
     connector<color::g> g(pointer<network>{ network::lookup.size() - 1 });
 
     network::source::list.emplace_back(*this);
@@ -1407,24 +1719,10 @@ connector<color::rg> network::source::getConnector() const
   }
   else
   {
-    std::vector<signal::WithValue> sum;
-    switch (this->flags & (network::source::isDeciOrAri | network::source::isConCom))
-    {
-    case network::source::isConCom:  
-      network::list[network::lookup[network::lookupIndex]].simulate(this->cCombinator);
-      network::list[network::lookup[network::lookupIndex + 1]].simulate(this->cCombinator);
-      break;
-    case network::source::isAriCom:
-      sum = this->redInput + this->greenInput;
-      network::list[network::lookup[network::lookupIndex    ]].simulate(this->aCombinator, sum);
-      network::list[network::lookup[network::lookupIndex + 1]].simulate(this->aCombinator, sum);
-      break;
-    case network::source::isDeciCom:
-      sum = this->redInput + this->greenInput;
-      network::list[network::lookup[network::lookupIndex    ]].simulate(this->dCombinator, sum);
-      network::list[network::lookup[network::lookupIndex + 1]].simulate(this->dCombinator, sum);
-      break;
-    }
+    assert(network::sourceIndex < network::source::list.size() && "the circuit code created more sources than while building it!");
+    network::source const& stored = network::source::list[network::sourceIndex++];
+    if (!(stored.flags & (network::source::isDuplicate | network::source::isEliminated)))
+      (stored.flags & network::source::isRewritten ? stored : *this).simulate(network::list[graph::networkOf[network::lookupIndex]], &network::list[graph::networkOf[network::lookupIndex + 1]]);
     return connector<color::rg>{ pointer<network>{ network::lookupIndex++ }, pointer<network>{ network::lookupIndex++ } };
   }
 }
@@ -1432,15 +1730,7 @@ connector<color::rg> network::source::getConnector() const
 
 void network::simulate(signal::WithValue const& sv)
 {
-  if (sv.value == 0)
-    return;
-  for (signal::WithValue& nsv : *this->nextValues)
-    if (sv.sig == nsv.sig)
-    {
-      nsv.value += sv.value;
-      return;
-    }
-  this->nextValues->push_back(sv);
+  this->nextValues->add(sv);
 }
 void network::simulate(conComData const& con)
 {
@@ -1461,26 +1751,26 @@ int32_t pow(int32_t left, int32_t right) {
   if (right < 0)
     return 0;
 
-  int32_t result = 1;
-  for (int32_t y = left; right; y *= y, right >>= 1)
-    if (right & 2)
+  uint32_t result = 1;
+  for (uint32_t y = static_cast<uint32_t>(left); right; y *= y, right >>= 1)
+    if (right & 1)
       result *= y;
 
-  return result;
+  return static_cast<int32_t>(result);
 }
 
-int32_t calculate(ariComData::Mode const& mode, int32_t const& left, int32_t const& right)
+int32_t calculate(ariComData::Mode::Enum const& mode, int32_t const& left, int32_t const& right)
 {
-  switch (static_cast<ariComData::Mode::Enum>(mode.description->index))
+  switch (mode)
   {
-  case ariComData::Mode::Enum::multiplicaton: return left * right;
+  case ariComData::Mode::Enum::multiplicaton: return static_cast<int32_t>(static_cast<uint32_t>(left) * static_cast<uint32_t>(right));
   case ariComData::Mode::Enum::division:      return right == 0 || (right == -1 && left == INT32_MIN) ? 0 : left / right;
-  case ariComData::Mode::Enum::addition:      return right + left;
-  case ariComData::Mode::Enum::subtraction:   return left - right;
+  case ariComData::Mode::Enum::addition:      return wrappingAdd(left, right);
+  case ariComData::Mode::Enum::subtraction:   return static_cast<int32_t>(static_cast<uint32_t>(left) - static_cast<uint32_t>(right));
   case ariComData::Mode::Enum::modulo:        return right == 0 || (right == -1 && left == INT32_MIN) ? 0 : left % right;
   case ariComData::Mode::Enum::power:         return pow(left, right);
-  case ariComData::Mode::Enum::shiftLeft:     return left << right;
-  case ariComData::Mode::Enum::shiftRight:    return left >> right;
+  case ariComData::Mode::Enum::shiftLeft:     return static_cast<int32_t>(static_cast<uint32_t>(left) << (right & 31)); // only the lowest 5 bits of the shift count are used
+  case ariComData::Mode::Enum::shiftRight:    return left >> (right & 31);
   case ariComData::Mode::Enum::bitAnd:        return left & right;
   case ariComData::Mode::Enum::bitOr:         return left | right;
   case ariComData::Mode::Enum::bitXor:        return left ^ right;
@@ -1488,10 +1778,14 @@ int32_t calculate(ariComData::Mode const& mode, int32_t const& left, int32_t con
   assert(false && "invalid arithmetic combinator mode!");
   throw;
 }
+int32_t calculate(ariComData::Mode const& mode, int32_t const& left, int32_t const& right)
+{
+  return calculate(static_cast<ariComData::Mode::Enum>(mode.description->index), left, right);
+}
 
-bool decide(deciComData::Mode const& mode, int32_t const& left, int32_t const& right)
+bool decide(deciComData::Mode::Enum const& mode, int32_t const& left, int32_t const& right)
 {
-  switch (static_cast<deciComData::Mode::Enum>(mode.description->index))
+  switch (mode)
   {
   case deciComData::Mode::Enum::smaller:      return left <  right;
   case deciComData::Mode::Enum::greater:      return left >  right;
@@ -1503,188 +1797,635 @@ bool decide(deciComData::Mode const& mode, int32_t const& left, int32_t const& r
   assert(false && "invalid decider combinator mode!");
   throw;
 }
+bool decide(deciComData::Mode const& mode, int32_t const& left, int32_t const& right)
+{
+  return decide(static_cast<deciComData::Mode::Enum>(mode.description->index), left, right);
+}
 
-void network::simulate(ariComData const& ari, std::vector<signal::WithValue> const& in)
+#ifdef COMBILER_SIMD
+// the integer vector operations the each kernels need, on the widest instruction set that is available
+// the right operand of a combinator is the same for all signals, which is why shifts, division and power take a scalar
+struct simd
 {
-  int32_t rightNum = std::visit(overload(
-    [](int32_t const& i) { return i; },
-    [&in](signal const& s) 
-    {
-      for (auto& sv : in)
-        if (sv.sig == s)
-          return sv.value;
-      return 0; 
-    }
-  ), ari.right);
+#ifdef __AVX2__
+  using type = __m256i;
+  static size_t constexpr width = 8;
+  static type load(int32_t const* p)     { return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)); }
+  static void store(int32_t* p, type v)  { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+  static type set(int32_t v)             { return _mm256_set1_epi32(v); }
+  static type add(type a, type b)        { return _mm256_add_epi32(a, b); }
+  static type sub(type a, type b)        { return _mm256_sub_epi32(a, b); }
+  static type mul(type a, type b)        { return _mm256_mullo_epi32(a, b); }
+  static type bitAnd(type a, type b)     { return _mm256_and_si256(a, b); }
+  static type bitOr(type a, type b)      { return _mm256_or_si256(a, b); }
+  static type bitXor(type a, type b)     { return _mm256_xor_si256(a, b); }
+  static type equal(type a, type b)      { return _mm256_cmpeq_epi32(a, b); }
+  static type greater(type a, type b)    { return _mm256_cmpgt_epi32(a, b); }
+  static type shiftLeft(type a, int32_t count)  { return _mm256_sll_epi32(a, _mm_cvtsi32_si128(count)); }
+  static type shiftRight(type a, int32_t count) { return _mm256_sra_epi32(a, _mm_cvtsi32_si128(count)); }
+  static uint32_t mask(type a)           { return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(a))); }
+  static type quotient(type a, int32_t b) // exact, since doubles represent every int32 and their quotient never rounds across an integer
+  {
+    __m256d d = _mm256_set1_pd(b);
+    __m128i low  = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(a)), d));
+    __m128i high = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(a, 1)), d));
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+  }
+#else
+  using type = __m128i;
+  static size_t constexpr width = 4;
+  static type load(int32_t const* p)     { return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p)); }
+  static void store(int32_t* p, type v)  { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+  static type set(int32_t v)             { return _mm_set1_epi32(v); }
+  static type add(type a, type b)        { return _mm_add_epi32(a, b); }
+  static type sub(type a, type b)        { return _mm_sub_epi32(a, b); }
+  static type mul(type a, type b) // sse2 only multiplies the even lanes into 64 bit results
+  {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd  = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+  }
+  static type bitAnd(type a, type b)     { return _mm_and_si128(a, b); }
+  static type bitOr(type a, type b)      { return _mm_or_si128(a, b); }
+  static type bitXor(type a, type b)     { return _mm_xor_si128(a, b); }
+  static type equal(type a, type b)      { return _mm_cmpeq_epi32(a, b); }
+  static type greater(type a, type b)    { return _mm_cmpgt_epi32(a, b); }
+  static type shiftLeft(type a, int32_t count)  { return _mm_sll_epi32(a, _mm_cvtsi32_si128(count)); }
+  static type shiftRight(type a, int32_t count) { return _mm_sra_epi32(a, _mm_cvtsi32_si128(count)); }
+  static uint32_t mask(type a)           { return static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(a))); }
+  static type quotient(type a, int32_t b) // exact, since doubles represent every int32 and their quotient never rounds across an integer
+  {
+    __m128d d = _mm_set1_pd(b);
+    __m128i low  = _mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(a), d));
+    __m128i high = _mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2))), d));
+    return _mm_unpacklo_epi64(low, high);
+  }
+#endif
+  static type zero()                     { return set(0); }
+  static type bitNot(type a)             { return bitXor(a, set(-1)); }
+  static int32_t sum(type a)
+  {
+    int32_t lanes[width];
+    store(lanes, a);
+    int32_t result = 0;
+    for (int32_t l : lanes)
+      result = wrappingAdd(result, l);
+    return result;
+  }
 
-  std::visit(overload(
-    [&, ari, in, rightNum](int32_t const& leftNum)
+  template<ariComData::Mode::Enum mode> static type calculate(type left, int32_t right)
+  {
+    using E = ariComData::Mode::Enum;
+    if constexpr (mode == E::multiplicaton) return mul(left, set(right));
+    if constexpr (mode == E::addition)      return add(left, set(right));
+    if constexpr (mode == E::subtraction)   return sub(left, set(right));
+    if constexpr (mode == E::shiftLeft)     return shiftLeft(left, right & 31);
+    if constexpr (mode == E::shiftRight)    return shiftRight(left, right & 31);
+    if constexpr (mode == E::bitAnd)        return bitAnd(left, set(right));
+    if constexpr (mode == E::bitOr)         return bitOr(left, set(right));
+    if constexpr (mode == E::bitXor)        return bitXor(left, set(right));
+    if constexpr (mode == E::division || mode == E::modulo)
     {
-      assert(std::holds_alternative<signal>(ari.output) && "arithmetic combinator can't have each output without each input!");
-      this->simulate(signal::WithValue{ calculate(ari.mode, leftNum, rightNum), std::get<signal>(ari.output) });
-    },
-    [&, rightNum](Each const&) 
+      if (right == 0 || (right == -1 && mode == E::modulo))
+        return zero();
+      if (right == -1) // INT32_MIN / -1 overflows, which results in 0 ingame
+        return bitAnd(bitNot(equal(left, set(INT32_MIN))), sub(zero(), left));
+      type q = quotient(left, right);
+      return mode == E::division ? q : sub(left, mul(q, set(right)));
+    }
+    if constexpr (mode == E::power)
     {
-      std::visit(overload(
-        [this, &ari, &in, &rightNum](signal const& outSig)
-        {
-          for (auto& sv : in)
-            this->simulate(signal::WithValue{ calculate(ari.mode, sv.value, rightNum), outSig });
-        },
-        [this, &ari, &in, &rightNum](Each const&)
-        {
-          for (auto& sv : in)
-            this->simulate(signal::WithValue{ calculate(ari.mode, sv.value, rightNum), sv.sig });
-        }
-        ), ari.output);
-    },
-    [&](signal const& leftSig) 
+      if (right == 0)
+        return set(1);
+      if (right < 0) // only 1 and -1 don't round to 0
+        return bitOr(bitAnd(equal(left, set(1)), set(1)), bitAnd(equal(left, set(-1)), set(right & 1 ? -1 : 1)));
+      type result = set(1);
+      for (type base = left; right; base = mul(base, base), right >>= 1)
+        if (right & 1)
+          result = mul(result, base);
+      return result;
+    }
+  }
+  template<deciComData::Mode::Enum mode> static type decide(type left, type right)
+  {
+    using E = deciComData::Mode::Enum;
+    if constexpr (mode == E::smaller)      return greater(right, left);
+    if constexpr (mode == E::greater)      return greater(left, right);
+    if constexpr (mode == E::equal)        return equal(left, right);
+    if constexpr (mode == E::greaterEqual) return bitNot(greater(right, left));
+    if constexpr (mode == E::smallerEqual) return bitNot(greater(left, right));
+    if constexpr (mode == E::notEqual)     return bitNot(equal(left, right));
+  }
+
+  // calls f(slot, input) for every vector of slots that contains a signal present on either input
+  template<class F> static void forEachInput(signalValues const* red, signalValues const* green, F const& f)
+  {
+    uint64_t constexpr lanes = (uint64_t(1) << width) - 1;
+    for (size_t w = 0; w < signalValues::words; w++)
     {
-      int32_t leftNum = 0;
-      for (auto& sv : in)
-        if (sv.sig == leftSig)
+      uint64_t bits = (red ? red->present[w] : 0) | (green ? green->present[w] : 0);
+      for (size_t k = 0; bits != 0 && k < 64; k += width)
+        if ((bits >> k) & lanes)
         {
-          leftNum = sv.value;
-          break;
+          size_t slot = w * 64 + k;
+          if (red && green)
+            f(slot, add(load(&red->values[slot]), load(&green->values[slot])));
+          else
+            f(slot, load(&(red ? red : green)->values[slot]));
         }
-      assert(std::holds_alternative<signal>(ari.output) && "arithmetic combinator can't have each output without each input!");
-      this->simulate(signal::WithValue{ calculate(ari.mode, leftNum, rightNum), std::get<signal>(ari.output) });
     }
-  ), ari.left);
+  }
+  // adds v to the values at slot and updates which of them are present
+  static void accumulate(signalValues& out, size_t slot, type v)
+  {
+    uint64_t constexpr lanes = (uint64_t(1) << width) - 1;
+    type sum = add(load(&out.values[slot]), v);
+    store(&out.values[slot], sum);
+    uint64_t& word = out.present[slot / 64];
+    word = (word & ~(lanes << (slot % 64))) | (uint64_t(mask(bitNot(equal(sum, zero())))) << (slot % 64));
+  }
+};
+#endif
+
+// kernels for combinators reading each signal, on the sum of both (possibly missing) inputs
+// with vector support they process whole vectors of slots at once, otherwise they fall back to one signal at a time
+template<ariComData::Mode::Enum mode> void eachCalculate(signalValues const* red, signalValues const* green, int32_t right, signalValues& out)
+{
+#ifdef COMBILER_SIMD
+  simd::forEachInput(red, green, [&](size_t slot, simd::type in)
+  {
+    simd::accumulate(out, slot, simd::bitAnd(simd::calculate<mode>(in, right), simd::bitNot(simd::equal(in, simd::zero()))));
+  });
+#else
+  forEachInput(red, green, [&](size_t slot, int32_t value) { out.add(slot, calculate(mode, value, right)); });
+#endif
+}
+template<ariComData::Mode::Enum mode> int32_t eachCalculateSum(signalValues const* red, signalValues const* green, int32_t right)
+{
+#ifdef COMBILER_SIMD
+  simd::type sum = simd::zero();
+  simd::forEachInput(red, green, [&](size_t, simd::type in)
+  {
+    sum = simd::add(sum, simd::bitAnd(simd::calculate<mode>(in, right), simd::bitNot(simd::equal(in, simd::zero()))));
+  });
+  return simd::sum(sum);
+#else
+  int32_t sum = 0;
+  forEachInput(red, green, [&](size_t, int32_t value) { sum = wrappingAdd(sum, calculate(mode, value, right)); });
+  return sum;
+#endif
+}
+template<deciComData::Mode::Enum mode> void eachDecide(signalValues const* red, signalValues const* green, int32_t right, bool copyCount, int32_t value, signalValues& out)
+{
+#ifdef COMBILER_SIMD
+  simd::type r = simd::set(right), v = simd::set(value);
+  simd::forEachInput(red, green, [&](size_t slot, simd::type in)
+  {
+    simd::type pass = simd::bitAnd(simd::decide<mode>(in, r), simd::bitNot(simd::equal(in, simd::zero())));
+    simd::accumulate(out, slot, simd::bitAnd(pass, copyCount ? v : in));
+  });
+#else
+  forEachInput(red, green, [&](size_t slot, int32_t in)
+  {
+    if (decide(mode, in, right))
+      out.add(slot, copyCount ? value : in);
+  });
+#endif
+}
+template<deciComData::Mode::Enum mode> int32_t eachDecideSum(signalValues const* red, signalValues const* green, int32_t right, bool copyCount, int32_t value)
+{
+#ifdef COMBILER_SIMD
+  simd::type r = simd::set(right), sum = simd::zero();
+  size_t count = 0;
+  simd::forEachInput(red, green, [&](size_t, simd::type in)
+  {
+    simd::type pass = simd::bitAnd(simd::decide<mode>(in, r), simd::bitNot(simd::equal(in, simd::zero())));
+    if (copyCount)
+      count += popCount(simd::mask(pass));
+    else
+      sum = simd::add(sum, simd::bitAnd(pass, in));
+  });
+  return copyCount ? static_cast<int32_t>(static_cast<uint32_t>(count) * static_cast<uint32_t>(value)) : simd::sum(sum);
+#else
+  int32_t sum = 0;
+  forEachInput(red, green, [&](size_t, int32_t in)
+  {
+    if (decide(mode, in, right))
+      sum = wrappingAdd(sum, copyCount ? value : in);
+  });
+  return sum;
+#endif
+}
+// any: true if some present signal passes, all: true unless some present signal fails
+template<deciComData::Mode::Enum mode, bool all> bool decideAnyAll(signalValues const* red, signalValues const* green, int32_t right)
+{
+  bool result = all;
+#ifdef COMBILER_SIMD
+  simd::type r = simd::set(right);
+  simd::forEachInput(red, green, [&](size_t, simd::type in)
+  {
+    simd::type present = simd::bitNot(simd::equal(in, simd::zero()));
+    simd::type pass = simd::decide<mode>(in, r);
+    if (all ? simd::mask(simd::bitAnd(present, simd::bitNot(pass))) != 0 : simd::mask(simd::bitAnd(present, pass)) != 0)
+      result = !all;
+  });
+#else
+  forEachInput(red, green, [&](size_t, int32_t in)
+  {
+    if (decide(mode, in, right) != all)
+      result = !all;
+  });
+#endif
+  return result;
+}
+template<deciComData::Mode::Enum mode> bool decideAny(signalValues const* red, signalValues const* green, int32_t right) { return decideAnyAll<mode, false>(red, green, right); }
+template<deciComData::Mode::Enum mode> bool decideAll(signalValues const* red, signalValues const* green, int32_t right) { return decideAnyAll<mode, true>(red, green, right); }
+
+// picks the kernel instantiation for a runtime mode
+#define ariKernel(kernel, mode, ...)                                                       \
+  [&]() { using E = ariComData::Mode::Enum; switch (mode) {                                \
+    case E::multiplicaton: return kernel<E::multiplicaton>(__VA_ARGS__);                   \
+    case E::division:      return kernel<E::division>(__VA_ARGS__);                        \
+    case E::addition:      return kernel<E::addition>(__VA_ARGS__);                        \
+    case E::subtraction:   return kernel<E::subtraction>(__VA_ARGS__);                     \
+    case E::modulo:        return kernel<E::modulo>(__VA_ARGS__);                          \
+    case E::power:         return kernel<E::power>(__VA_ARGS__);                           \
+    case E::shiftLeft:     return kernel<E::shiftLeft>(__VA_ARGS__);                       \
+    case E::shiftRight:    return kernel<E::shiftRight>(__VA_ARGS__);                      \
+    case E::bitAnd:        return kernel<E::bitAnd>(__VA_ARGS__);                          \
+    case E::bitOr:         return kernel<E::bitOr>(__VA_ARGS__);                           \
+    default:               return kernel<E::bitXor>(__VA_ARGS__); } }()
+#define deciKernel(kernel, mode, ...)                                                      \
+  [&]() { using E = deciComData::Mode::Enum; switch (mode) {                               \
+    case E::smaller:      return kernel<E::smaller>(__VA_ARGS__);                          \
+    case E::greater:      return kernel<E::greater>(__VA_ARGS__);                          \
+    case E::equal:        return kernel<E::equal>(__VA_ARGS__);                            \
+    case E::greaterEqual: return kernel<E::greaterEqual>(__VA_ARGS__);                     \
+    case E::smallerEqual: return kernel<E::smallerEqual>(__VA_ARGS__);                     \
+    default:              return kernel<E::notEqual>(__VA_ARGS__); } }()
+
+inline int32_t inputOf(signalValues const* red, signalValues const* green, size_t slot)
+{
+  return wrappingAdd(red ? (*red)[slot] : 0, green ? (*green)[slot] : 0);
+}
+template<class Right> int32_t rightOf(Right const& right, signalValues const* red, signalValues const* green)
+{
+  if (int32_t const* i = std::get_if<int32_t>(&right))
+    return *i;
+  return inputOf(red, green, std::get<signal>(right).description->slot);
+}
 
+// one instantiation per mode and combination of left input and output kind, so that evaluating doesn't visit any variants
+template<ariComData::Mode::Enum mode, class Left, class Output>
+void evaluateAri(network::source const& source, signalValues const* red, signalValues const* green, signalValues& out)
+{
+  ariComData const& ari = source.aCombinator;
+  int32_t right = rightOf(ari.right, red, green);
+  if constexpr (std::is_same_v<Left, Each>)
+  {
+    if constexpr (std::is_same_v<Output, Each>)
+      eachCalculate<mode>(red, green, right, out);
+    else
+      out.add(std::get<signal>(ari.output).description->slot, eachCalculateSum<mode>(red, green, right));
+  }
+  else
+  {
+    int32_t left;
+    if constexpr (std::is_same_v<Left, int32_t>)
+      left = std::get<int32_t>(ari.left);
+    else
+      left = inputOf(red, green, std::get<signal>(ari.left).description->slot);
+    out.add(std::get<signal>(ari.output).description->slot, calculate(mode, left, right));
+  }
 }
-void network::simulate(deciComData const& deci, std::vector<signal::WithValue> const& in)
+template<deciComData::Mode::Enum mode, class Left, class Output>
+void evaluateDeci(network::source const& source, signalValues const* red, signalValues const* green, signalValues& out)
 {
-  int32_t rightNum = std::visit(overload(
-    [](int32_t const& i) { return i; },
-    [&in](signal const& s)
+  deciComData const& deci = source.dCombinator;
+  int32_t right = rightOf(deci.right, red, green);
+  bool copyCount = deci.value.has_value();
+  int32_t value = deci.value.value_or(0);
+  if constexpr (std::is_same_v<Left, Each>)
+  {
+    if constexpr (std::is_same_v<Output, Each>)
+      eachDecide<mode>(red, green, right, copyCount, value, out);
+    else
+      out.add(std::get<signal>(deci.output).description->slot, eachDecideSum<mode>(red, green, right, copyCount, value));
+  }
+  else
+  {
+    bool result;
+    if constexpr (std::is_same_v<Left, Any>)
+      result = decideAny<mode>(red, green, right);
+    else if constexpr (std::is_same_v<Left, All>)
+      result = decideAll<mode>(red, green, right);
+    else
+      result = decide(mode, inputOf(red, green, std::get<signal>(deci.left).description->slot), right);
+    if (!result)
+      return;
+    if constexpr (std::is_same_v<Output, All>)
+    {
+      if (copyCount)
+        forEachInput(red, green, [&](size_t slot, int32_t) { out.add(slot, value); });
+      else
+        forEachInput(red, green, [&](size_t slot, int32_t in) { out.add(slot, in); });
+    }
+    else
     {
-      for (auto& sv : in)
-        if (sv.sig == s)
-          return sv.value;
-      return 0;
+      size_t slot = std::get<signal>(deci.output).description->slot;
+      out.add(slot, copyCount ? value : inputOf(red, green, slot));
     }
-  ), deci.right);
+  }
+}
 
-  bool result = std::visit(overload(
-    [&, deci, in, rightNum](Any const&) 
-    {
-      for (auto& sv : in)
-        if (decide(deci.mode, sv.value, rightNum))
-          return true;
-      return false;
-    },
-    [&, deci, in, rightNum](All const&)
+template<ariComData::Mode::Enum mode> network::source::evaluator ariEvaluator(ariComData const& ari)
+{
+  return std::visit([](auto const& left, auto const& output) -> network::source::evaluator
+  {
+    using Left = std::decay_t<decltype(left)>;
+    using Output = std::decay_t<decltype(output)>;
+    if constexpr (std::is_same_v<Output, Each> && !std::is_same_v<Left, Each>)
     {
-      for (auto& sv : in)
-        if (!decide(deci.mode, sv.value, rightNum))
-          return false;
-      return true;
-    },
-    [&, deci, in, rightNum](signal const& s)
+      assert(false && "arithmetic combinator can't have each output without each input!");
+      return nullptr;
+    }
+    else
+      return &evaluateAri<mode, Left, Output>;
+  }, ari.left, ari.output);
+}
+template<deciComData::Mode::Enum mode> network::source::evaluator deciEvaluator(deciComData const& deci)
+{
+  return std::visit([](auto const& left, auto const& output) -> network::source::evaluator
+  {
+    using Left = std::decay_t<decltype(left)>;
+    using Output = std::decay_t<decltype(output)>;
+    if constexpr (std::is_same_v<Left, Each> && std::is_same_v<Output, All>)
     {
-      int32_t leftNum = 0;
-      for (auto& sv : in)
-        if (sv.sig == s)
-        {
-          leftNum = sv.value; 
-          break;
-        }
-      return decide(deci.mode, leftNum, rightNum);
-    },
-    [&, deci, in, rightNum](Each const&)
+      assert(false && "decider combinator can only have signal or each output when input is each!");
+      return nullptr;
+    }
+    else if constexpr (!std::is_same_v<Left, Each> && std::is_same_v<Output, Each>)
     {
-      assert(std::holds_alternative<Each>(deci.output) || std::holds_alternative<signal>(deci.output) && "decider combinator can only have signal or each output when input is each!");
-      assert((!deci.value.has_value() || deci.value.value() == 1) && "decider combinator output value can only be 1!");
-      if (std::holds_alternative<signal>(deci.output))
-      {
-        signal out = std::get<signal>(deci.output);
-        int32_t sum = 0;
-        if (deci.value.has_value())
-        {
-          for (auto& sv : in)
-            if (decide(deci.mode, sv.value, rightNum))
-              sum++;
-          this->simulate(signal::WithValue{ sum * deci.value.value(), out });
-        }
-        else
-        {
-          for (auto& sv : in)
-            if (decide(deci.mode, sv.value, rightNum))
-              sum += sv.value;
-          this->simulate(signal::WithValue{ sum, out });
-        }
-      }
-      else
-      {
-        if (deci.value.has_value())
-        {
-          for (auto& sv : in)
-            if (decide(deci.mode, sv.value, rightNum))
-              this->simulate(signal::WithValue{ deci.value.value(), sv.sig });
-        }
-        else
-        {
-          for (auto& sv : in)
-            if (decide(deci.mode, sv.value, rightNum))
-              this->simulate(sv);
-        }
-      }
-      return false;
+      assert(false && "decider combinator can only have signal or all output when input is all!");
+      return nullptr;
     }
-  ), deci.left);
-
-  if (result)
+    else
+      return &evaluateDeci<mode, Left, Output>;
+  }, deci.left, deci.output);
+}
+void network::source::resolve()
+{
+  if (this->flags & isAriCom)
+    this->evaluate = ariKernel(ariEvaluator, static_cast<ariComData::Mode::Enum>(this->aCombinator.mode.description->index), this->aCombinator);
+  else
   {
-    assert(std::holds_alternative<All>(deci.output) || std::holds_alternative<signal>(deci.output) && "decider combinator can only have signal or all output when input is all!");
-    assert((!deci.value.has_value() || deci.value.value() == 1) && "decider combinator output value can only be 1!");
-    std::visit(overload(
-      [](Each const&) { assert(false && "this code cannot be reached"); },
-      [&, deci, in](All const&) 
-      {
-        if (deci.value.has_value())
-        {
-          int32_t val = deci.value.value();
-          for (auto& sv : in)
-              this->simulate(signal::WithValue{ val, sv.sig });
-        }
-        else
-          for (auto& sv : in)
-            this->simulate(sv);
-      },
-      [&, deci, in](signal const& s) 
-      {
-        if (deci.value.has_value())
-          this->simulate(signal::WithValue{ deci.value.value(), s });
-        else
-        {
-          for (auto& sv : in)
-            if (sv.sig == s)
-            {
-              this->simulate(sv);
-              break;
-            }
-        }
-      }
-    ), deci.output);
+    assert((!this->dCombinator.value.has_value() || this->dCombinator.value.value() == 1) && "decider combinator output value can only be 1!");
+    this->evaluate = deciKernel(deciEvaluator, static_cast<deciComData::Mode::Enum>(this->dCombinator.mode.description->index), this->dCombinator);
   }
 }
 
+// opt-in instrumentation of the simulation through getConnector, which attributes calls, signals and time to every source and network
+// sources are identified by the order in which the circuit code creates them, which is the same every tick
+struct profiler
+{
+  struct sourceStats
+  {
+    uint64_t calls = 0;
+    uint64_t signalsRead = 0;    // present input signals for each, any and all, otherwise the number of signal operands
+    uint64_t signalsWritten = 0; // per output network
+    uint64_t nanoseconds = 0;
+  };
+  struct networkStats
+  {
+    uint64_t writes = 0; // source outputs summed into this network
+    uint64_t signalsWritten = 0;
+    uint64_t nanoseconds = 0; // spent in the sources writing into this network
+    uint64_t ticks = 0;
+    std::vector<uint64_t> cardinality; // cardinality[b] counts ticks with 0 (b == 0) or [2^(b-1), 2^b) present signals
+  };
 
+  static thread_local bool enabled;
+  static thread_local std::vector<sourceStats> sources; // indexed like network::source::list
+  static thread_local std::vector<networkStats> networks; // indexed like network::list
 
+  static void reset();
+  static void simulate(network::source const& source, network& out, network* second);
+  static void recordTick();
+  static std::string report(size_t top = 20); // sources and networks sorted by time spent
+  static std::string json();                  // sources keyed by entity number as numbered by stringify()
 
-template<color c>
-conCom<c>::operator connector<c>() const { return network::source(this->data).getConnector<c>(); }
-conCom<color::rg>::operator connector<color::rg>() const { return network::source(this->data).getConnector<color::rg>(); }
+  static size_t signalsRead(network::source const& source, signalValues const* red, signalValues const* green);
+  static std::string describe(network::source const& source);
+};
+thread_local bool profiler::enabled = false;
+thread_local std::vector<profiler::sourceStats> profiler::sources;
+thread_local std::vector<profiler::networkStats> profiler::networks;
 
-template<color c>
-wire<c> wire<c>::loop()
+void network::source::simulate(network& out, network* second) const
 {
-  if (::network::simIndex == 0)
+  if (profiler::enabled)
+    return profiler::simulate(*this, out, second);
+  switch (this->flags & (network::source::isDeciOrAri | network::source::isConCom))
   {
-    ::network::list.emplace_back(::network{ {}, { ::network::lookup.size() }, {}, c, network::isLoop });
-    ::network::lookup.emplace_back(::network::list.size() - 1);
-    return wire(pointer<::network>(network::lookup.size() - 1));
+  case network::source::isConCom:
+    out.simulate(this->cCombinator);
+    if (second)
+      second->simulate(this->cCombinator);
+    break;
+  case network::source::isAriCom:
+  case network::source::isDeciCom:
+    this->evaluate(*this, lastValuesOf(this->redInput), lastValuesOf(this->greenInput), *out.nextValues);
+    if (second)
+      this->evaluate(*this, lastValuesOf(this->redInput), lastValuesOf(this->greenInput), *second->nextValues);
+    break;
+  }
+}
+
+void profiler::reset()
+{
+  sources.clear();
+  networks.clear();
+}
+size_t profiler::signalsRead(network::source const& source, signalValues const* red, signalValues const* green)
+{
+  auto present = [&]()
+  {
+    size_t result = 0;
+    forEachInput(red, green, [&result](size_t, int32_t) { result++; });
+    return result;
+  };
+  auto isSignal = [](auto const& operand) { return size_t(std::holds_alternative<signal>(operand)); };
+  switch (source.flags & (network::source::isDeciOrAri | network::source::isConCom))
+  {
+  case network::source::isAriCom:
+  {
+    ariComData const& ari = source.aCombinator;
+    return std::holds_alternative<Each>(ari.left) ? present() : isSignal(ari.left) + isSignal(ari.right);
+  }
+  case network::source::isDeciCom:
+  {
+    deciComData const& deci = source.dCombinator;
+    if (!std::holds_alternative<signal>(deci.left) || std::holds_alternative<All>(deci.output))
+      return present();
+    return 1 + isSignal(deci.right) + (isSignal(deci.output) && !deci.value.has_value());
+  }
+  default:
+    return 0;
+  }
+}
+void profiler::simulate(network::source const& source, network& out, network* second)
+{
+  static thread_local signalValues result;
+  size_t index = network::sourceIndex - 1;
+  if (sources.size() < network::source::list.size())
+    sources.resize(network::source::list.size());
+  if (networks.size() < network::list.size())
+    networks.resize(network::list.size());
+
+  bool isConCom = source.flags & network::source::isConCom;
+  // the inputs of constant combinators overlap their data
+  signalValues const* red = isConCom ? nullptr : lastValuesOf(source.redInput);
+  signalValues const* green = isConCom ? nullptr : lastValuesOf(source.greenInput);
+  auto start = std::chrono::steady_clock::now();
+  result.clear();
+  if (isConCom)
+  {
+    for (auto const& osv : source.cCombinator)
+      if (osv.has_value())
+        result.add(osv.value());
+  }
+  else
+    source.evaluate(source, red, green, result);
+  uint64_t nanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+  size_t written = result.count();
+
+  sourceStats& stats = sources[index];
+  stats.calls++;
+  stats.signalsRead += isConCom ? 0 : signalsRead(source, red, green);
+  stats.nanoseconds += nanoseconds;
+  for (network* net : { &out, second })
+    if (net)
+    {
+      *net->nextValues += result;
+      stats.signalsWritten += written;
+      networkStats& netStats = networks[net - &network::list[0]];
+      netStats.writes++;
+      netStats.signalsWritten += written;
+      netStats.nanoseconds += nanoseconds;
+    }
+}
+void profiler::recordTick()
+{
+  if (networks.size() < network::list.size())
+    networks.resize(network::list.size());
+  for (size_t n = 0; n < network::list.size(); n++)
+  {
+    size_t count = network::list[n].lastValues->count();
+    size_t bucket = 0;
+    while (count >> bucket)
+      bucket++;
+    std::vector<uint64_t>& cardinality = networks[n].cardinality;
+    if (cardinality.size() <= bucket)
+      cardinality.resize(bucket + 1, 0);
+    cardinality[bucket]++;
+    networks[n].ticks++;
+  }
+}
+std::string profiler::describe(network::source const& source)
+{
+  std::ostringstream out;
+  if (source.entity.index != -1)
+    out << "entity " << source.entity.index + 1;
+  else
+    out << "source " << (&source - &network::source::list[0]) << " (not in the blueprint)";
+  switch (source.flags & (network::source::isDeciOrAri | network::source::isConCom))
+  {
+  case network::source::isConCom:  out << ", constant"; break;
+  case network::source::isAriCom:  out << ", arithmetic " << source.aCombinator.mode.description->gameSyntax; break;
+  case network::source::isDeciCom: out << ", decider " << source.dCombinator.mode.description->gameSyntax; break;
+  }
+  return out.str();
+}
+std::string profiler::report(size_t top)
+{
+  std::ostringstream out;
+  std::vector<size_t> order(sources.size());
+  for (size_t i = 0; i < order.size(); i++)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), [](size_t a, size_t b) { return sources[a].nanoseconds > sources[b].nanoseconds; });
+  out << "sources by time spent:\n";
+  for (size_t i = 0; i < order.size() && i < top; i++)
+  {
+    sourceStats const& stats = sources[order[i]];
+    out << "  " << describe(network::source::list[order[i]]) << ": " << stats.nanoseconds << " ns in " << stats.calls << " calls, "
+        << stats.signalsRead << " signals read, " << stats.signalsWritten << " written\n";
+  }
+  order.resize(networks.size());
+  for (size_t i = 0; i < order.size(); i++)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), [](size_t a, size_t b) { return networks[a].nanoseconds > networks[b].nanoseconds; });
+  out << "networks by time spent in their writers:\n";
+  for (size_t i = 0; i < order.size() && i < top; i++)
+  {
+    networkStats const& stats = networks[order[i]];
+    out << "  network " << order[i] << ": " << stats.nanoseconds << " ns in " << stats.writes << " writes, " << stats.signalsWritten << " signals written, cardinality";
+    for (size_t b = 0; b < stats.cardinality.size(); b++)
+      if (stats.cardinality[b] != 0)
+        out << " [" << (b == 0 ? 0 : size_t(1) << (b - 1)) << ", " << (size_t(1) << b) << "): " << stats.cardinality[b];
+    out << "\n";
+  }
+  return out.str();
+}
+std::string profiler::json()
+{
+  std::ostringstream out;
+  out << "{\"sources\":{";
+  bool first = true;
+  for (size_t i = 0; i < sources.size(); i++)
+  {
+    network::source const& source = network::source::list[i];
+    if (source.entity.index == -1)
+      continue;
+    sourceStats const& stats = sources[i];
+    out << (first ? "" : ",") << "\"" << source.entity.index + 1 << "\":{\"calls\":" << stats.calls << ",\"signalsRead\":" << stats.signalsRead
+        << ",\"signalsWritten\":" << stats.signalsWritten << ",\"nanoseconds\":" << stats.nanoseconds << "}";
+    first = false;
+  }
+  out << "},\"networks\":[";
+  for (size_t n = 0; n < networks.size(); n++)
+  {
+    networkStats const& stats = networks[n];
+    out << (n == 0 ? "" : ",") << "{\"writers\":[";
+    for (size_t w = 0; w < network::list[n].sources.size(); w++)
+    {
+      pointer<entity> e = network::list[n].sources[w]->entity;
+      out << (w == 0 ? "" : ",") << (e.index == -1 ? std::string("null") : std::to_string(e.index + 1));
+    }
+    out << "],\"writes\":" << stats.writes << ",\"signalsWritten\":" << stats.signalsWritten << ",\"nanoseconds\":" << stats.nanoseconds
+        << ",\"ticks\":" << stats.ticks << ",\"cardinality\":[";
+    for (size_t b = 0; b < stats.cardinality.size(); b++)
+      out << (b == 0 ? "" : ",") << stats.cardinality[b];
+    out << "]}";
+  }
+  out << "]}";
+  return out.str();
+}
+
+
+
+
+
+template<color c>
+conCom<c>::operator connector<c>() const { return network::source(this->data).getConnector<c>(); }
+conCom<color::rg>::operator connector<color::rg>() const { return network::source(this->data).getConnector<color::rg>(); }
+
+template<color c>
+wire<c> wire<c>::loop()
+{
+  if (::network::simIndex == 0)
+  {
+    ::network::list.emplace_back(::network{ {}, ::network::newId(), {}, c, network::isLoop });
+    return wire(pointer<::network>(network::lookup.size() - 1));
   }
   else
     return wire(pointer<::network>(::network::lookupIndex++));
@@ -1724,10 +2465,26 @@ connector<color::rg> operator+=(connector<color::g> const& left, connector<color
 
 enum class connectionType { standard, input, output,  };
 
+// sparse index of the poles by tile, which hashes chunks of 16 x 16 tiles, so that it grows with the poles instead of the area of the blueprint
+struct poleGrid
+{
+  static uint64_t constexpr chunk = 16;
+  std::unordered_map<uint64_t, std::array<pointer<entity>, chunk * chunk>> chunks;
+
+  pointer<entity> at(uint64_t x, uint64_t y) const // nullptr if there is no pole
+  {
+    auto found = this->chunks.find(x / chunk << 32 | y / chunk);
+    return found == this->chunks.end() ? pointer<entity>(nullptr) : found->second[y % chunk * chunk + x % chunk];
+  }
+  pointer<entity>& operator()(uint64_t x, uint64_t y)
+  {
+    return this->chunks[x / chunk << 32 | y / chunk][y % chunk * chunk + x % chunk];
+  }
+};
 struct entity
 {
-  static std::vector<entity> list;
-  static std::vector<std::vector<pointer<entity>>> xyToPole;
+  static thread_local std::vector<entity> list;
+  static thread_local poleGrid xyToPole;
   pointer<network::source> source;
   pointer<entity> entity_number;
   std::tuple<float, float> position;
@@ -1744,35 +2501,22 @@ struct entity
       return gConnection[i == connectionType::output];
   }
 };
-std::vector<entity> entity::list;
-std::vector<std::vector<pointer<entity>>> entity::xyToPole;
+thread_local std::vector<entity> entity::list;
+thread_local poleGrid entity::xyToPole;
 
 pointer<entity> poleAt(uint64_t const& x, uint64_t const& y)
 {
-  pointer<entity> result;
-  if (entity::xyToPole.size() > x && entity::xyToPole[x].size() > y && (result = entity::xyToPole[x][y]))
-    return result;
-  else
+  pointer<entity>& result = entity::xyToPole(x, y);
+  if (!result)
   {
     entity::list.emplace_back(entity());
     entity& pole = entity::list.back();
     pole.position = { static_cast<float>(x), static_cast<float>(y) };
     pole.entity_number = entity::list.size() - 1;
     pole.source = nullptr;
-    uint64_t maxX = std::max<uint64_t>(entity::xyToPole.size(), x + 1);
-    if (maxX > 0) maxX--;
-    uint64_t maxY = entity::xyToPole.size() == 0 ? y + 1 : std::max<uint64_t>(entity::xyToPole[0].size(), y + 1);
-    if (maxY > 0) maxY--;
-    for (size_t px = 0; px <= maxX; px++)
-    {
-      if (entity::xyToPole.size() <= maxX)
-        entity::xyToPole.emplace_back(std::vector<pointer<entity>>(maxY + 1, nullptr));
-      else
-        for (size_t py = entity::xyToPole[px].size(); py <= maxY; py++)
-          entity::xyToPole[px].emplace_back(-1);
-    }
-    return entity::xyToPole[x][y] = pole.entity_number;
+    result = pole.entity_number;
   }
+  return result;
 }
 
 void flagSourcesForOutput(network& net)
@@ -1796,339 +2540,3785 @@ void flagSourcesForOutput(network& net)
   }
 }
 
-std::string encode64(const std::string& data)
+// flags everything the main outputs depend on, again after passes changed the networks
+void flagAllForOutput()
 {
-  std::string result = "0";
-  result.reserve((data.length() + 2) / 3 * 4 + 1);
-  const std::array<const char, 64> base64Chars =
-  {
-    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
-    'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f',
-    'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v',
-    'w', 'x', 'y', 'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'
-  };
-  size_t i;
-  uint32_t bits;
-  for (i = 2; i < data.length(); i += 3)
-  {
-    bits = (static_cast<uint8_t>(data[i - 2]) << 16) 
-         | (static_cast<uint8_t>(data[i - 1]) <<  8) 
-         |  static_cast<uint8_t>(data[i]);
-    result.append(1, base64Chars[ bits >> 18            ]);
-    result.append(1, base64Chars[(bits >> 12) & 0b111111]);
-    result.append(1, base64Chars[(bits >>  6) & 0b111111]);
-    result.append(1, base64Chars[(bits      ) & 0b111111]);
-  }
-  switch (i - data.length())
-  {
-  case 0:
-    bits = (static_cast<uint8_t>(data[i - 2]) << 8) 
-         |  static_cast<uint8_t>(data[i - 1]);
-    result.append(1, base64Chars[ bits >> 10            ]);
-    result.append(1, base64Chars[(bits >>  4) & 0b111111]);
-    result.append(1, base64Chars[(bits <<  2) & 0b111111]);
-    result.append(1, '=');
-    break;
-  case 1:
-    bits = static_cast<uint8_t>(data[i - 2]);
-    result.append(1, base64Chars[ bits >> 2            ]);
-    result.append(1, base64Chars[(bits << 4) & 0b111111]);
-    result.append(2, '=');
-    break;
-  case 2:
-    break;
-  }
-  assert(result.length() == (data.length() + 2) / 3 * 4 + 1);
-  return result;
+  for (network::source& source : network::source::list)
+    source.flags = static_cast<decltype(source.flags)>(source.flags & ~network::source::isOutputRelevant);
+  for (network& net : network::list)
+    net.flags = static_cast<decltype(net.flags)>(net.flags & ~network::isOutputRelevant);
+  for (network& net : network::list)
+    if (net.flags & network::isMainOutput)
+      flagSourcesForOutput(net);
 }
-
-std::string compress(const std::string& data)
+size_t countOutputRelevant()
 {
-  auto requiredSize = compressBound(static_cast<uLong>(data.size()));
-  std::string result;
-  result.resize(requiredSize);
-
-  auto code = compress2(reinterpret_cast<Bytef*>(&result[0]), &requiredSize, reinterpret_cast<const Bytef*>(data.data()), static_cast<uLong>(data.size()), 9);
-  switch (code)
+  return static_cast<size_t>(std::count_if(network::source::list.begin(), network::source::list.end(), [](network::source const& s)
   {
-  case Z_OK: break;
-  case Z_MEM_ERROR: throw std::runtime_error("Compression failed: not enough memory.");
-  case Z_BUF_ERROR: throw std::runtime_error("Compression failed: not enough room in the output buffer.");
-  case Z_STREAM_ERROR: throw std::runtime_error("Invalid compression level: 9.");
-  default:
-    throw std::runtime_error("Compression failed: unknown error.");
-  }
-
-  result.resize(requiredSize);
-  return result;
-}
-
-std::ostream& operator<<(std::ostream& out, Any const&) { return out << "{\"type\":\"virtual\",\"name\":\"signal-anything\"}"; }
-std::ostream& operator<<(std::ostream& out, All const&) { return out << "{\"type\":\"virtual\",\"name\":\"signal-everything\"}"; }
-std::ostream& operator<<(std::ostream& out, Each const&) { return out << "{\"type\":\"virtual\",\"name\":\"signal-each\"}"; }
-std::ostream& operator<<(std::ostream& out, signal const& s) 
-{
-  return out << "{\"type\":\"" << s.description->type << "\",\"name\":\"" << s.description->gameSyntax << "\"}"; 
-}
-std::ostream& operator<<(std::ostream& out, signal::WithValue const& sv) 
-{
-  return out << "\"signal\":" << sv.sig << ",\"count\":" << sv.value;
-}
-std::ostream& operator<<(std::ostream& out, conComData const& c) 
-{
-  out << "constant-combinator\",\"control_behavior\":{\"filters\":[";
-  for (size_t j = 0; j < c.size(); j++)
-    if (c[j].has_value())
-      out << "{" << c[j].value() << ",\"index\":" << (j + 1) << "},";
-  out.seekp(-1, out.cur);
-  return out << "]},";
-}
-std::ostream& operator<<(std::ostream& out, deciComData const& d) 
-{
-  out << "decider-combinator\",\"control_behavior\":{\"decider_conditions\":{\"first_signal\":";
-  std::visit([&out](auto const& l) -> std::ostream& { return out << l; }, d.left) << ",";
-  std::visit(overload(
-    [&out](int32_t const& i) { out << "\"constant\":" << i; },
-    [&out](signal const& s) { out << "\"second_signal\":" << s << ""; }
-  ), d.right);
-  out << ",\"comparator\":\"" << d.mode.description->gameSyntax << "\",\"output_signal\":";
-  std::visit([&out](auto const& l) -> std::ostream& { return out << l; }, d.output);
-  return out << ",\"copy_count_from_input\":" << (d.value.has_value() ? "false}}," : "true}},");
-}
-std::ostream& operator<<(std::ostream& out, ariComData const& a) 
-{
-  out << "arithmetic-combinator\",\"control_behavior\":{\"arithmetic_conditions\":{";
-  std::visit(overload(
-    [&out](int32_t const& i) { out << "\"first_constant\":" << i << ","; },
-    [&out](auto const& s) { out << "\"first_signal\":" << s << ","; }
-  ), a.left);
-  std::visit(overload(
-    [&out](int32_t const& i) { out << "\"second_constant\":" << i << ","; },
-    [&out](signal const& s) { out << "\"second_signal\":" << s << ","; }
-  ), a.right);
-  out << "\"operation\":\"" << a.mode.description->gameSyntax << "\",\"output_signal\":";
-  return std::visit([&out](auto const& l) -> std::ostream& { return out << l; }, a.output) << "}},";
-}
-std::ostream& operator<<(std::ostream& out, std::tuple<pointer<entity>, connectionType> const& connector) 
-{
-  const auto [first, second] = connector;
-  out << "{\"entity_id\":" << first.index + 1;
-  if (second != connectionType::standard)
-    out << ",\"circuit_id\":" << static_cast<int>(second);
-  return out << "}";
+    return (s.flags & network::source::isOutputRelevant) != 0;
+  }));
 }
-template<class T> std::ostream& operator<<(std::ostream& out, std::vector<T> const& vec)
+// removes the targets of networks which passes took out of the circuit or which don't read the network anymore
+void dropUnusedTargets()
 {
-  out << "[";
-  for (auto& el : vec)
-    out << el << ",";
-  out.seekp(-1, out.cur);
-  return out << "]";
+  std::vector<uint8_t> isUsed(network::source::list.size(), 0);
+  for (network const& net : network::list)
+    for (pointer<network::source> const& ps : net.sources)
+      isUsed[ps.index] = 1;
+  for (size_t n = 0; n < network::list.size(); n++)
+  {
+    std::vector<pointer<network::source>>& targets = network::list[n].targets;
+    targets.erase(std::remove_if(targets.begin(), targets.end(), [n, &isUsed](pointer<network::source> const& target)
+    {
+      auto reads = [n](pointer<network> const& in) { return in.index != -1 && network::indexOf(in.index) == n; };
+      return !isUsed[target.index] || !(target->flags & network::source::isDeciOrAri) || !(reads(target->redInput) || reads(target->greenInput));
+    }), targets.end());
+  }
 }
-std::ostream& operator<<(std::ostream& out, entity const& e)
+// superset of the signals every network in network::list can carry
+std::vector<signalValues::bits> possibleSignals()
 {
-  out << "{\"entity_number\":" << (&e - &entity::list[0] + 1) << ",\"position\":{\"x\":" << std::get<0>(e.position) << ",\"y\":" << -std::get<1>(e.position) << "},";
-  if (e.direction != 0)
-    out << "\"direction\":" << e.direction << ",";
-  out << "\"name\":\"";
-  if (e.source == nullptr)
-    out << "medium-electric-pole\",";
-  else
-    switch (e.source->flags & (network::source::isDeciOrAri | network::source::isConCom))
+  std::vector<signalValues::bits> result(network::list.size(), signalValues::bits{});
+  auto set = [](signalValues::bits& bits, size_t slot) { bits[slot / 64] |= uint64_t(1) << (slot % 64); };
+  auto addInputs = [&result](size_t s, signalValues::bits& bits)
+  {
+    for (uint32_t in : { graph::red[s], graph::green[s] })
+      if (in != graph::none)
+        for (size_t w = 0; w < signalValues::words; w++)
+          bits[w] |= result[in][w];
+  };
+
+  std::vector<size_t> pending; // sources whose inputs changed
+  for (size_t s = 0; s < network::source::list.size(); s++)
+    pending.push_back(s);
+  while (!pending.empty())
+  {
+    size_t s = pending.back();
+    network::source const& source = network::source::list[s];
+    pending.pop_back();
+    signalValues::bits bits = {};
+    switch (source.flags & (network::source::isDeciOrAri | network::source::isConCom))
     {
-    case network::source::isConCom:  out << e.source->cCombinator; break;
-    case network::source::isDeciCom: out << e.source->dCombinator; break;
-    case network::source::isAriCom:  out << e.source->aCombinator; break;
+    case network::source::isConCom:
+      for (auto const& osv : source.cCombinator)
+        if (osv.has_value())
+          set(bits, osv.value().sig.description->slot);
+      break;
+    case network::source::isAriCom:
+      if (signal const* out = std::get_if<signal>(&source.aCombinator.output))
+        set(bits, out->description->slot);
+      else
+        addInputs(s, bits);
+      break;
+    case network::source::isDeciCom:
+      if (signal const* out = std::get_if<signal>(&source.dCombinator.output))
+        set(bits, out->description->slot);
+      else
+        addInputs(s, bits);
+      break;
     }
-  out << "\"connections\":{";
-  for (size_t i = 0; i < e.rConnection.size(); i++)
-  {
-    out << "\"" << (i + 1) << "\":{";
-    if (e.rConnection[i].size() != 0)
+    for (uint32_t n : graph::outputs[s])
     {
-      out << "\"red\":" << e.rConnection[i];
-      if (e.gConnection[i].size() != 0)
-        out << ",\"green\":" << e.gConnection[i];
+      signalValues::bits next = result[n];
+      for (size_t w = 0; w < signalValues::words; w++)
+        next[w] |= bits[w];
+      if (next == result[n])
+        continue;
+      result[n] = next;
+      for (uint32_t reader : graph::readers[n])
+        pending.push_back(reader);
     }
-    else
-      out << "\"green\":" << e.gConnection[i];
-    out << "},";
   }
-  out.seekp(-1, out.cur);
-  return out << "}}";
+  return result;
 }
-std::string stringify()
+
+// replaces decider and arithmetic combinators whose output never changes by the constant combinators of the networks they write into
+// runs in compile() before the entities are generated. Folded networks hold their final values from the first tick on, also when
+// simulating the circuit code, which simulates the folded sources in place of its own
+struct constantFolding
 {
-  std::ostringstream out;
-  out << "{\"blueprint\":{\"icons\":[{\"signal\":" << itemSignal::decider_combinator << ",\"index\":1}],"
-      << "\"entities\":" << entity::list << ",\"item\":\"blueprint\",\"version\":73018310664}}";
-  return encode64(compress(out.str()));
+  static bool enabled;
+  static thread_local size_t eliminated; // combinators that the last compile() didn't need to place
+  static thread_local size_t folded;     // decider and arithmetic combinators among them, or replaced by constant combinators
+
+  static void run();
+  static bool isInputIndependent(network::source const& source);
+};
+bool constantFolding::enabled = true;
+thread_local size_t constantFolding::eliminated = 0;
+thread_local size_t constantFolding::folded = 0;
+
+bool constantFolding::isInputIndependent(network::source const& source)
+{
+  if (source.flags & network::source::isConCom)
+    return true;
+  if (source.flags & network::source::isAriCom)
+  {
+    using E = ariComData::Mode::Enum;
+    ariComData const& ari = source.aCombinator;
+    int32_t const* right = std::get_if<int32_t>(&ari.right);
+    if (right == nullptr)
+      return false;
+    if (std::holds_alternative<int32_t>(ari.left))
+      return true;
+    E mode = static_cast<E>(ari.mode.description->index);
+    return *right == 0 && (mode == E::multiplicaton || mode == E::division || mode == E::modulo || mode == E::bitAnd); // every input becomes 0
+  }
+  // a signal compared to itself decides the same for every value, so the output only depends on the input if it copies it
+  deciComData const& deci = source.dCombinator;
+  signal const* left = std::get_if<signal>(&deci.left);
+  if (left == nullptr || !std::holds_alternative<signal>(deci.right) || std::get<signal>(deci.right).description != left->description)
+    return false;
+  return !decide(deci.mode, 0, 0) || (deci.value.has_value() && std::holds_alternative<signal>(deci.output));
 }
 
-std::string compile(uint16_t lengthOfValueHistory)
+void constantFolding::run()
 {
-  network::simIndex = 1;
-  network::lookupIndex = 0;
-  for (network& net : network::list) 
+  eliminated = folded = 0;
+  if (!enabled)
+    return;
+  std::vector<network::source>& sources = network::source::list;
+  size_t relevantBefore = countOutputRelevant();
+
+  // find all constant networks, starting from the sources that don't depend on their inputs
+  std::vector<size_t> pendingNetworks(network::list.size()); // sources of a network that aren't known to be constant yet
+  std::vector<size_t> pendingInputs(sources.size());         // inputs of a source that aren't known to be constant yet
+  std::vector<uint8_t> isConstant(network::list.size(), 0);
+  std::vector<signalValues> values(network::list.size());
+  std::vector<size_t> constantSources;
+  for (size_t n = 0; n < network::list.size(); n++)
+    pendingNetworks[n] = graph::writers[n].size();
+  for (size_t s = 0; s < sources.size(); s++)
   {
-    net.flags = static_cast<decltype(net.flags)>(net.flags & !network::isOutputRelevant);
-    net.values = std::vector(lengthOfValueHistory, std::vector<signal::WithValue>());
-    net.lastValues = net.nextValues;
-    net.nextValues = &net.values[network::simIndex - 1];
+    if (!isInputIndependent(sources[s]))
+      pendingInputs[s] = (graph::red[s] != graph::none) + (graph::green[s] != graph::none);
+    if (pendingInputs[s] == 0)
+      constantSources.push_back(s);
   }
-  for (network& net : network::list)
-    if (net.flags & network::isMainOutput)
-      flagSourcesForOutput(net);
-  for (network::source& source : network::source::list)
-    if (source.flags & network::source::isOutputRelevant)
-    {
-      entity next;
-      next.source = pointer<network::source>(&source - &network::source::list[0]);
-      source.entity = next.entity_number = entity::list.size();
-      next.position = { static_cast<float>(next.entity_number.index), source.flags & network::source::isDeciOrAri ? 0.5f : 1.0f };
-      if (source.flags & network::source::isDeciOrAri)
-      {
-        next.rConnection.emplace_back(std::vector<std::tuple<pointer<entity>, connectionType>>());
-        next.gConnection.emplace_back(std::vector<std::tuple<pointer<entity>, connectionType>>());
-      }
-      entity::list.emplace_back(next);
-    }
-  struct connection
+  auto constantInput = [&](pointer<network> const& in) -> signalValues const*
   {
-    pointer<entity> entity = -1;
-    connectionType index = connectionType::standard;
-    uint8_t wires = 0;
+    return in.index != -1 && isConstant[graph::networkOf[in.index]] ? &values[graph::networkOf[in.index]] : nullptr;
   };
-  struct compiledNetwork
+  auto addOutput = [&](network::source const& source, signalValues& out)
   {
-    color c;
-    enum : uint8_t {
-      none               = 0b0000,
-      isMainOutput       = 0b0001,
-      needsExtenderPoles = 0b0010
-    } flags;
-    uint64_t y = 0;
-    std::vector<connection> connections; // maps into entities via first, bool true = input, false = output
-  };
-  std::vector<compiledNetwork> cNetworks;
-  for (network net : network::list)
-    if (net.flags & network::isOutputRelevant)
+    if (source.flags & network::source::isConCom)
     {
-      compiledNetwork next;
-      for (pointer<network::source>& source : net.sources)
-        if (source->entity)
-          next.connections.push_back({ source->entity, source->flags & network::source::isDeciOrAri ? connectionType::output : connectionType::standard });
-      for (pointer<network::source>& target : net.targets)
-        if (target->entity)
-          next.connections.push_back({ target->entity, connectionType::input });
-      next.c = net.c;
-      next.flags = net.flags & network::isMainOutput ? compiledNetwork::isMainOutput : compiledNetwork::none;
-      cNetworks.emplace_back(next);
+      for (auto const& osv : source.cCombinator)
+        if (osv.has_value())
+          out.add(osv.value());
     }
-  for (compiledNetwork& n : cNetworks)
-  {
-    for (size_t j = 1; j < n.connections.size(); j++)
-    {
-      connection& l = n.connections[j - 1];
-      connection& r = n.connections[j];
-      if (std::abs(static_cast<int64_t>(l.entity - r.entity)) <= 10)
-      {
-        (*l.entity)(n.c, l.index).push_back({ r.entity, r.index });
-        (*r.entity)(n.c, r.index).push_back({ l.entity, l.index });
-      }
-      else
+    else
+      source.evaluate(source, constantInput(source.redInput), constantInput(source.greenInput), out);
+  };
+  for (size_t i = 0; i < constantSources.size(); i++)
+    for (uint32_t n : graph::outputs[constantSources[i]])
+      if (--pendingNetworks[n] == 0)
       {
-        setFlag(n.flags, compiledNetwork::needsExtenderPoles);
-        l.wires++;
-        r.wires++;
+        for (uint32_t w : graph::writers[n])
+          addOutput(sources[w], values[n]);
+        isConstant[n] = 1;
+        for (uint32_t reader : graph::readers[n])
+          if (pendingInputs[reader] != 0 && --pendingInputs[reader] == 0)
+            constantSources.push_back(reader);
       }
-    }
-    if (n.flags & compiledNetwork::isMainOutput)
-      n.connections.back().wires++;
-  }
-  int64_t redNetworks = 0;
-  int64_t greenNetworks = 0;
-  for (compiledNetwork& n : cNetworks)
-    if (n.flags & (compiledNetwork::isMainOutput | compiledNetwork::needsExtenderPoles))
-    {
-      int64_t raw = (n.c == color::r ? redNetworks : greenNetworks)++ * 5;
-      n.y = (raw - 1) / 7 * 9 + (raw - 1) % 7 + 3;
-    }
+  std::vector<uint8_t> isConstantSource(sources.size(), 0);
+  for (size_t s : constantSources)
+    isConstantSource[s] = 1;
 
-  uint64_t outputPostX = entity::list.size() + 2;
-  for (compiledNetwork& cnet : cNetworks)
+  // merge the constant sources of every network into as few constant combinators as possible, reusing their places in network::source::list
+  for (size_t n = 0; n < network::list.size(); n++)
   {
-    size_t xLastPole = -1; pointer<entity> iLastPole = nullptr;
-    for (connection con : cnet.connections)
-      if (con.wires != 0)
+    network& net = network::list[n];
+    if (!(net.flags & network::isOutputRelevant))
+      continue;
+    std::vector<size_t> replaceable; // constant sources that only write into this network
+    bool hasDeciOrAri = false;
+    signalValues merged;
+    for (pointer<network::source> const& ps : net.sources)
+      if (isConstantSource[ps.index] && graph::outputs[ps.index].size() == 1)
       {
-        uint64_t x = con.entity.index;
-        uint64_t y0 = std::min<int64_t>(cnet.y, con.index == connectionType::input ? 8 : 9);
-        pointer<entity> pole = poleAt(x, y0);
-        (*con.entity)(cnet.c, con.index).push_back({ pole, connectionType::standard });
-        (*pole)(cnet.c).push_back({ con.entity, con.index });
-        pointer<entity> lastPole = pole;
-
-        if (y0 < cnet.y)
-          for (y0 = std::min(y0 + 9, cnet.y); y0 <= cnet.y; y0 += 9)
-          {
-            pole = poleAt(x, y0);
-            (*lastPole)(cnet.c).push_back({ pole.index, connectionType::standard });
-            (*pole)(cnet.c).push_back({ lastPole.index, connectionType::standard });
-            lastPole = pole;
-          }
-        if (iLastPole)
-        {
-          while ((xLastPole = std::max(xLastPole + 1, std::min(xLastPole + 9, x))) <= x)
-          {
-            pointer<entity> pole = poleAt(xLastPole, cnet.y);
-            (*iLastPole)(cnet.c).push_back({ pole.index, connectionType::standard });
-            (*pole)(cnet.c).push_back({ iLastPole.index, connectionType::standard });
-            iLastPole = pole;
-          }
-          if (con.wires == 1)
-          {
-            xLastPole = -1;
-            iLastPole = nullptr;
-          }
-        }
-        else
-        {
-          iLastPole = lastPole;
-          xLastPole = x;
-        }
+        replaceable.push_back(ps.index);
+        hasDeciOrAri |= (sources[ps.index].flags & network::source::isDeciOrAri) != 0;
+        addOutput(sources[ps.index], merged);
       }
-    if (cnet.flags & compiledNetwork::isMainOutput)
-      while ((xLastPole = std::max(xLastPole + 1, std::min(xLastPole + 9, outputPostX))) <= outputPostX)
+    size_t needed = (merged.count() + 17) / 18;
+    if (needed == 0 && replaceable.size() == net.sources.size() && (net.flags & network::isMainOutput))
+      needed = 1; // the output of the blueprint needs an entity to connect to
+    if (replaceable.empty() || needed > replaceable.size() || (!hasDeciOrAri && needed == replaceable.size()))
+      continue;
+
+    std::vector<conComData> combinators(needed, conComData{});
+    size_t i = 0;
+    merged.forEach([&](size_t slot, int32_t value) { combinators[i / 18][i % 18] = signalValues::signalAt(slot) = value; i++; });
+    for (size_t s : replaceable)
+      folded += (sources[s].flags & network::source::isDeciOrAri) != 0;
+    for (size_t c = 0; c < needed; c++)
+    {
+      pointer<entity> e = sources[replaceable[c]].entity;
+      sources[replaceable[c]] = network::source(combinators[c]);
+      sources[replaceable[c]].entity = e;
+      setFlag(sources[replaceable[c]].flags, network::source::isRewritten);
+    }
+    for (size_t c = needed; c < replaceable.size(); c++)
+      setFlag(sources[replaceable[c]].flags, network::source::isEliminated);
+    net.sources.erase(std::remove_if(net.sources.begin(), net.sources.end(), [&](pointer<network::source> const& ps)
+    {
+      return std::find(replaceable.begin() + needed, replaceable.end(), ps.index) != replaceable.end();
+    }), net.sources.end());
+    if (net.sources.empty())
+      // an empty network reads the same as no network
+      for (uint32_t reader : graph::readers[n])
       {
-        pointer<entity> pole = poleAt(xLastPole, cnet.y);
-        (*iLastPole)(cnet.c).push_back({ pole.index, connectionType::standard });
-        (*pole)(cnet.c).push_back({ iLastPole.index, connectionType::standard });
-        iLastPole = pole;
+        if (!(sources[reader].flags & network::source::isDeciOrAri))
+          continue; // folded into a constant combinator
+        if (graph::red[reader] == n)
+          sources[reader].redInput = nullptr;
+        if (graph::green[reader] == n)
+          sources[reader].greenInput = nullptr;
       }
   }
-  return stringify();
+
+  dropUnusedTargets();
+  flagAllForOutput();
+  graph::freeze();
+  eliminated = relevantBefore - countOutputRelevant();
 }
 
+// rewrites arithmetic combinators that apply the same operation to different single signals of the same inputs and write into
+// the same network into one combinator with each input. That is only equivalent if the inputs can't carry any other signal,
+// since each would process those too, and if the operation turns 0 into 0, since each skips the signals that aren't present
+struct combinatorFusion
+{
+  static bool enabled;
+  static thread_local size_t saved; // combinators that the last compile() didn't need to place
+  static thread_local size_t fused; // each combinators that replaced a group
 
-std::string compileFirstOrSimulate(uint16_t lengthOfValueHistory)
+  static void run();
+};
+bool combinatorFusion::enabled = true;
+thread_local size_t combinatorFusion::saved = 0;
+thread_local size_t combinatorFusion::fused = 0;
+
+void combinatorFusion::run()
 {
-  if (network::simIndex == 0)
-    return compile(lengthOfValueHistory);
-  else
+  saved = fused = 0;
+  if (!enabled)
+    return;
+  using E = ariComData::Mode::Enum;
+  std::vector<network::source>& sources = network::source::list;
+  size_t relevantBefore = countOutputRelevant();
+  std::vector<signalValues::bits> possible = possibleSignals();
+
+  for (network& net : network::list)
+  {
+    if (!(net.flags & network::isOutputRelevant))
+      continue;
+    // candidates grouped by mode, right operand, inputs and whether they output on their left signal or sum into one signal
+    std::map<std::string, std::vector<size_t>> groups;
+    for (pointer<network::source> const& ps : net.sources)
+    {
+      network::source const& source = *ps;
+      if (!(source.flags & network::source::isAriCom) || graph::outputs[ps.index].size() != 1)
+        continue;
+      ariComData const& ari = source.aCombinator;
+      signal const* left = std::get_if<signal>(&ari.left);
+      signal const* output = std::get_if<signal>(&ari.output);
+      if (left == nullptr || output == nullptr)
+        continue;
+      E mode = static_cast<E>(ari.mode.description->index);
+      int32_t const* right = std::get_if<int32_t>(&ari.right);
+      bool keepsZero = right ? calculate(mode, 0, *right) == 0
+        : mode == E::multiplicaton || mode == E::division || mode == E::modulo || mode == E::shiftLeft || mode == E::shiftRight || mode == E::bitAnd;
+      if (!keepsZero)
+        continue;
+      uint32_t red = graph::red[ps.index], green = graph::green[ps.index];
+      std::ostringstream key;
+      key << ari.mode.description->index << ' ' << ari.right.index() << ':'
+          << (right ? *right : static_cast<int32_t>(std::get<signal>(ari.right).description->slot))
+          << ' ' << std::min(red, green) << ' ' << std::max(red, green) << ' ' << (*output == *left ? std::string("each") : std::to_string(output->description->slot));
+      groups[key.str()].push_back(ps.index);
+    }
+
+    std::vector<size_t> removed;
+    for (auto const& [key, group] : groups)
+    {
+      if (group.size() < 2)
+        continue;
+      signalValues::bits lefts = {};
+      bool distinct = true;
+      for (size_t s : group)
+      {
+        size_t slot = std::get<signal>(sources[s].aCombinator.left).description->slot;
+        distinct &= !(lefts[slot / 64] >> (slot % 64) & 1);
+        lefts[slot / 64] |= uint64_t(1) << (slot % 64);
+      }
+      bool onlyLefts = true;
+      for (uint32_t in : { graph::red[group.front()], graph::green[group.front()] })
+        if (in != graph::none)
+          for (size_t w = 0; w < signalValues::words; w++)
+            onlyLefts &= (possible[in][w] & ~lefts[w]) == 0;
+      if (!distinct || !onlyLefts)
+        continue;
+
+      network::source& fusedSource = sources[group.front()];
+      ariComData& ari = fusedSource.aCombinator;
+      if (std::get<signal>(ari.output) == std::get<signal>(ari.left))
+        ari.output = each;
+      ari.left = each;
+      fusedSource.resolve();
+      setFlag(fusedSource.flags, network::source::isRewritten);
+      for (auto s = group.begin() + 1; s != group.end(); s++)
+        setFlag(sources[*s].flags, network::source::isEliminated);
+      removed.insert(removed.end(), group.begin() + 1, group.end());
+      fused++;
+    }
+    if (!removed.empty())
+      net.sources.erase(std::remove_if(net.sources.begin(), net.sources.end(), [&removed](pointer<network::source> const& ps)
+      {
+        return std::find(removed.begin(), removed.end(), ps.index) != removed.end();
+      }), net.sources.end());
+  }
+  dropUnusedTargets();
+  flagAllForOutput();
+  graph::freeze();
+  saved = relevantBefore - countOutputRelevant();
+}
+
+// merges sources that compute the same output from the same inputs, so that every such subexpression becomes only one entity
+// networks written by the same multiset of equivalent sources carry the same values and are merged into one. Equivalent sources
+// writing into one network are kept, since each of them adds its output to the network
+struct commonSubexpressions
+{
+  static bool enabled;
+  static thread_local size_t saved;  // combinators that the last compile() didn't need to place
+  static thread_local size_t merged; // networks merged into equivalent ones
+
+  static void run();
+  static std::string keyOf(network::source const& source); // equal for sources with equal outputs on every tick
+};
+bool commonSubexpressions::enabled = true;
+thread_local size_t commonSubexpressions::saved = 0;
+thread_local size_t commonSubexpressions::merged = 0;
+
+std::string commonSubexpressions::keyOf(network::source const& source)
+{
+  std::ostringstream key;
+  auto operand = [&key](auto const& variant)
+  {
+    key << ' ' << variant.index();
+    std::visit(overload(
+      [&key](int32_t const& i) { key << ':' << i; },
+      [&key](signal const& s) { key << ':' << s.description->slot; },
+      [](auto const&) {}
+    ), variant);
+  };
+  switch (source.flags & (network::source::isDeciOrAri | network::source::isConCom))
+  {
+  case network::source::isConCom:
+  {
+    signalValues sum;
+    for (auto const& osv : source.cCombinator)
+      if (osv.has_value())
+        sum.add(osv.value());
+    key << 'c';
+    sum.forEach([&key](size_t slot, int32_t value) { key << ' ' << slot << ':' << value; });
+    return key.str();
+  }
+  case network::source::isAriCom:
+    key << 'a' << source.aCombinator.mode.description->index;
+    operand(source.aCombinator.left);
+    operand(source.aCombinator.right);
+    operand(source.aCombinator.output);
+    break;
+  case network::source::isDeciCom:
+    key << 'd' << source.dCombinator.mode.description->index;
+    operand(source.dCombinator.left);
+    operand(source.dCombinator.right);
+    operand(source.dCombinator.output);
+    key << ' ' << source.dCombinator.value.has_value();
+    break;
+  }
+  // both inputs are summed, so which one is red doesn't matter for the output
+  auto id = [](pointer<network> const& in) { return in.index == -1 ? size_t(-1) : network::find(in.index); };
+  size_t red = id(source.redInput), green = id(source.greenInput);
+  key << " < " << std::min(red, green) << ' ' << std::max(red, green);
+  return key.str();
+}
+
+void commonSubexpressions::run()
+{
+  saved = merged = 0;
+  if (!enabled)
+    return;
+  std::vector<network::source>& sources = network::source::list;
+  size_t relevantBefore = countOutputRelevant();
+
+  // sources writing into two networks are left alone, since both would need to be merged for the source to go away
+  // graph::outputs stays correct while merging, since merged networks only lose sources flagged as duplicates
+
+  // merging networks changes the keys of the sources reading them, so repeat until nothing merges anymore
+  for (bool changed = true; changed;)
+  {
+    changed = false;
+    std::unordered_map<std::string, size_t> classes; // key to the first source with it
+    std::vector<size_t> classOf(sources.size(), size_t(-1));
+    for (size_t s = 0; s < sources.size(); s++)
+      if (graph::outputs[s].size() == 1 && !(sources[s].flags & network::source::isDuplicate))
+        classOf[s] = classes.emplace(keyOf(sources[s]), s).first->second;
+
+    std::map<std::pair<color, std::vector<size_t>>, size_t> networks; // classes of the sources of a network to its lookup index
+    std::vector<std::pair<size_t, size_t>> merges;                    // lookup indices of the network to merge and the one to merge it into
+    for (network const& net : network::list)
+    {
+      std::vector<size_t> key;
+      for (pointer<network::source> const& ps : net.sources)
+        key.push_back(classOf[ps.index]);
+      if (key.empty() || std::find(key.begin(), key.end(), size_t(-1)) != key.end())
+        continue;
+      std::sort(key.begin(), key.end());
+      auto [it, isNew] = networks.emplace(std::make_pair(net.c, std::move(key)), net.id);
+      if (isNew)
+        continue;
+      network const& first = network::list[network::indexOf(it->second)];
+      if (!(net.flags & network::isMainOutput))
+        merges.emplace_back(net.id, it->second);
+      else if (!(first.flags & network::isMainOutput))
+      {
+        // keep the main output, which the blueprint needs to show
+        merges.emplace_back(it->second, net.id);
+        it->second = net.id;
+      }
+    }
+    for (auto [from, into] : merges)
+    {
+      network& duplicate = *pointer<network>(from);
+      network& kept = *pointer<network>(into);
+      if (&duplicate == &kept)
+        continue;
+      for (pointer<network::source> const& ps : duplicate.sources)
+        setFlag(sources[ps.index].flags, network::source::isDuplicate);
+      duplicate.sources.clear();
+      kept.targets.insert(kept.targets.end(), duplicate.targets.begin(), duplicate.targets.end());
+      duplicate.targets.clear();
+      duplicate.redirectTo(kept);
+      merged++;
+      changed = true;
+    }
+  }
+  network::compact();
+  dropUnusedTargets();
+  flagAllForOutput();
+  graph::freeze();
+  saved = relevantBefore - countOutputRelevant();
+}
+
+// backward analysis of which signals of every output relevant network can influence a main output, following network::targets
+// networks drop their other signals when a tick is complete and program::freeze() leaves out the combinators only writing them
+struct liveness
+{
+  static bool enabled;
+  static thread_local size_t deadSignals;                // signals that networks could carry but don't need to, summed over all networks
+  static thread_local std::vector<std::string> warnings; // consumers with each, any or all inputs that keep every signal of their inputs live
+
+  static void run();
+  static signalValues::bits inputsNeeded(network::source const& source, signalValues::bits const& outputsNeeded, bool& needsAll);
+};
+bool liveness::enabled = true;
+thread_local size_t liveness::deadSignals = 0;
+thread_local std::vector<std::string> liveness::warnings;
+
+signalValues::bits liveness::inputsNeeded(network::source const& source, signalValues::bits const& outputsNeeded, bool& needsAll)
+{
+  signalValues::bits result = {};
+  needsAll = false;
+  auto set = [&result](signal const& s) { result[s.description->slot / 64] |= uint64_t(1) << (s.description->slot % 64); };
+  auto isNeeded = [&outputsNeeded](signal const& s) { return (outputsNeeded[s.description->slot / 64] >> (s.description->slot % 64) & 1) != 0; };
+  auto addOutputs = [&]() { for (size_t w = 0; w < signalValues::words; w++) result[w] |= outputsNeeded[w]; };
+  auto setOperand = [&set](auto const& operand) { if (signal const* s = std::get_if<signal>(&operand)) set(*s); };
+  bool anyNeeded = std::any_of(outputsNeeded.begin(), outputsNeeded.end(), [](uint64_t w) { return w != 0; });
+  if (!anyNeeded || (source.flags & network::source::isConCom))
+    return result;
+
+  if (source.flags & network::source::isAriCom)
+  {
+    ariComData const& ari = source.aCombinator;
+    signal const* output = std::get_if<signal>(&ari.output);
+    if (output != nullptr && !isNeeded(*output))
+      return result;
+    setOperand(ari.right);
+    if (std::holds_alternative<Each>(ari.left))
+    {
+      if (output != nullptr)
+        needsAll = true; // the sum depends on every signal
+      else
+        addOutputs();
+    }
+    else
+      setOperand(ari.left);
+    return result;
+  }
+  deciComData const& deci = source.dCombinator;
+  signal const* output = std::get_if<signal>(&deci.output);
+  if (output != nullptr && !isNeeded(*output))
+    return result;
+  setOperand(deci.right);
+  if (signal const* left = std::get_if<signal>(&deci.left))
+  {
+    set(*left);
+    if (output == nullptr)
+      addOutputs(); // all copies every signal or outputs 1 on it
+    else if (!deci.value.has_value())
+      set(*output);
+  }
+  else if (std::holds_alternative<Each>(deci.left) && output == nullptr)
+    addOutputs();
+  else
+    needsAll = true; // any and all decide on every signal, each summed into a signal counts or sums every signal
+  return result;
+}
+
+void liveness::run()
+{
+  deadSignals = 0;
+  warnings.clear();
+  for (network& net : network::list)
+    net.flags = static_cast<decltype(net.flags)>(net.flags & ~network::hasDeadSignals);
+  if (!enabled)
+    return;
+  signalValues::bits everything = {};
+  for (size_t slot = 0; slot < signalValues::size; slot++)
+    everything[slot / 64] |= uint64_t(1) << (slot % 64);
+  std::vector<size_t> pending;
+  for (size_t n = 0; n < network::list.size(); n++)
+  {
+    network& net = network::list[n];
+    net.live = net.flags & network::isMainOutput ? everything : signalValues::bits{};
+    if (net.flags & network::isMainOutput)
+      pending.push_back(n);
+  }
+
+  std::vector<uint8_t> isWarned(network::source::list.size(), 0);
+  while (!pending.empty())
+  {
+    size_t n = pending.back();
+    pending.pop_back();
+    for (uint32_t s : graph::writers[n])
+    {
+      network::source const& source = network::source::list[s];
+      signalValues::bits outputsNeeded = {};
+      for (uint32_t out : graph::outputs[s])
+        for (size_t w = 0; w < signalValues::words; w++)
+          outputsNeeded[w] |= network::list[out].live[w];
+      bool needsAll;
+      signalValues::bits needed = inputsNeeded(source, outputsNeeded, needsAll);
+      if (needsAll)
+      {
+        needed = everything;
+        if (!isWarned[s])
+          warnings.push_back(profiler::describe(source) + " reads every signal of its inputs, which keeps them all live");
+        isWarned[s] = 1;
+      }
+      for (uint32_t i : { graph::red[s], graph::green[s] })
+        if (i != graph::none)
+        {
+          signalValues::bits next = network::list[i].live;
+          for (size_t w = 0; w < signalValues::words; w++)
+            next[w] |= needed[w];
+          if (next != network::list[i].live)
+          {
+            network::list[i].live = next;
+            pending.push_back(i);
+          }
+        }
+    }
+  }
+
+  std::vector<signalValues::bits> possible = possibleSignals();
+  for (size_t n = 0; n < network::list.size(); n++)
+  {
+    network& net = network::list[n];
+    if (!(net.flags & network::isOutputRelevant))
+      continue;
+    size_t dead = 0;
+    for (size_t w = 0; w < signalValues::words; w++)
+      dead += popCount(possible[n][w] & ~net.live[w]);
+    if (dead != 0)
+      setFlag(net.flags, network::hasDeadSignals);
+    deadSignals += dead;
+  }
+}
+
+// abstract interpretation of the circuit over intervals, which bound the value of every signal on every network over all ticks,
+// including the feedback of looped wires. Values start at 0 and absent signals are 0, so every interval contains 0
+// transfer functions follow calculate() and decide(), a result that could overflow becomes the whole int32 range
+struct valueRanges
+{
+  struct interval
+  {
+    int32_t min = 0, max = 0;
+    bool isEmpty() const { return this->min > this->max; }
+    bool isConstant() const { return this->min == this->max; }
+    bool isBoolean() const { return this->min >= 0 && this->max <= 1; }
+    bool operator==(interval const& o) const { return this->min == o.min && this->max == o.max; }
+    bool operator!=(interval const& o) const { return !(*this == o); }
+  };
+  static bool enabled;
+  static thread_local size_t removed; // decider and arithmetic combinators that can't ever output anything, which the last compile() left out
+
+  static interval of(pointer<network> const& net, signal const& s); // [0, 0] for signals the network can't carry
+  static uint8_t bitsNeeded(pointer<network> const& net, signal const& s); // width of a signed integer that holds every value
+  static std::string report();
+  static void run();
+
+  static thread_local std::vector<signalValues::bits> possible;  // indexed like network::list
+  static thread_local std::vector<std::vector<interval>> ranges; // the intervals of the possible signals of every network in the order of their slots
+
+  static interval full() { return { INT32_MIN, INT32_MAX }; }
+  static interval clamp(int64_t min, int64_t max) { return min < INT32_MIN || max > INT32_MAX ? full() : interval{ static_cast<int32_t>(min), static_cast<int32_t>(max) }; }
+  static interval hull(interval const& a, interval const& b);
+  static interval add(interval const& a, interval const& b) { return clamp(int64_t(a.min) + b.min, int64_t(a.max) + b.max); }
+  static interval calculate(ariComData::Mode::Enum mode, interval const& left, interval const& right);
+  static int decide(deciComData::Mode::Enum mode, interval const& left, interval const& right); // 1 if always true, 0 if never, -1 otherwise
+  static interval restrict(deciComData::Mode::Enum mode, interval const& left, interval const& right); // left values that can decide true
+  static interval at(size_t net, size_t slot);
+  static void evaluate(size_t s, std::vector<interval>& out); // adds the output of network::source::list[s] to out, indexed by slot
+};
+bool valueRanges::enabled = true;
+thread_local size_t valueRanges::removed = 0;
+thread_local std::vector<signalValues::bits> valueRanges::possible;
+thread_local std::vector<std::vector<valueRanges::interval>> valueRanges::ranges;
+
+valueRanges::interval valueRanges::hull(interval const& a, interval const& b)
+{
+  if (a.isEmpty())
+    return b;
+  if (b.isEmpty())
+    return a;
+  return { std::min(a.min, b.min), std::max(a.max, b.max) };
+}
+valueRanges::interval valueRanges::calculate(ariComData::Mode::Enum mode, interval const& left, interval const& right)
+{
+  using E = ariComData::Mode::Enum;
+  if (left.isConstant() && right.isConstant())
+  {
+    int32_t result = ::calculate(mode, left.min, right.min);
+    return { result, result };
+  }
+  int64_t magnitude = std::max(std::abs(int64_t(left.min)), std::abs(int64_t(left.max)));
+  switch (mode)
+  {
+  case E::multiplicaton:
+  {
+    int64_t products[] = { int64_t(left.min) * right.min, int64_t(left.min) * right.max, int64_t(left.max) * right.min, int64_t(left.max) * right.max };
+    return clamp(*std::min_element(products, products + 4), *std::max_element(products, products + 4));
+  }
+  case E::addition:    return add(left, right);
+  case E::subtraction: return clamp(int64_t(left.min) - right.max, int64_t(left.max) - right.min);
+  case E::division: // |left / right| <= |left|, with the sign of left for positive right
+  case E::modulo:   // |left % right| <= |left| and the result has the sign of left
+    if (mode == E::modulo && right.isConstant() && right.min != 0)
+      magnitude = std::min(magnitude, std::abs(int64_t(right.min)) - 1);
+    if (mode == E::division && right.isConstant() && right.min != 0 && right.min != -1)
+    {
+      int32_t a = left.min / right.min, b = left.max / right.min;
+      return { std::min(a, b), std::max(a, b) };
+    }
+    if (mode == E::division && right.min < 0)
+      return clamp(-magnitude, magnitude);
+    return clamp(left.min >= 0 ? 0 : -magnitude, left.max <= 0 ? 0 : magnitude);
+  case E::shiftLeft:
+    if (right.isConstant() && (right.min & 31) < 31)
+      return clamp(int64_t(left.min) << (right.min & 31), int64_t(left.max) << (right.min & 31));
+    return full();
+  case E::shiftRight:
+    if (right.isConstant())
+      return { left.min >> (right.min & 31), left.max >> (right.min & 31) };
+    return { std::min(left.min, 0), std::max(left.max, 0) };
+  case E::bitAnd:
+    if (left.min >= 0 || right.min >= 0)
+      return { 0, left.min >= 0 && right.min >= 0 ? std::min(left.max, right.max) : (left.min >= 0 ? left.max : right.max) };
+    return full();
+  case E::bitOr:
+  case E::bitXor:
+    if (left.min >= 0 && right.min >= 0)
+    {
+      int32_t bits = 1;
+      while (bits <= std::max(left.max, right.max) && bits < (1 << 30))
+        bits <<= 1;
+      return { 0, bits <= std::max(left.max, right.max) ? INT32_MAX : bits - 1 };
+    }
+    return full();
+  default:
+    return full();
+  }
+}
+int valueRanges::decide(deciComData::Mode::Enum mode, interval const& left, interval const& right)
+{
+  using E = deciComData::Mode::Enum;
+  switch (mode)
+  {
+  case E::smaller:      return left.max <  right.min ? 1 : left.min >= right.max ? 0 : -1;
+  case E::greater:      return left.min >  right.max ? 1 : left.max <= right.min ? 0 : -1;
+  case E::greaterEqual: return left.min >= right.max ? 1 : left.max <  right.min ? 0 : -1;
+  case E::smallerEqual: return left.max <= right.min ? 1 : left.min >  right.max ? 0 : -1;
+  case E::equal:        return left.isConstant() && right.isConstant() && left.min == right.min ? 1 : left.max < right.min || left.min > right.max ? 0 : -1;
+  default:              return left.isConstant() && right.isConstant() && left.min == right.min ? 0 : left.max < right.min || left.min > right.max ? 1 : -1;
+  }
+}
+valueRanges::interval valueRanges::restrict(deciComData::Mode::Enum mode, interval const& left, interval const& right)
+{
+  using E = deciComData::Mode::Enum;
+  switch (mode)
+  {
+  case E::smaller:      return right.min == INT32_MIN && right.max == INT32_MIN ? interval{ 1, 0 } : interval{ left.min, std::min(left.max, right.max - (right.max != INT32_MIN)) };
+  case E::greater:      return right.min == INT32_MAX && right.max == INT32_MAX ? interval{ 1, 0 } : interval{ std::max(left.min, right.min + (right.min != INT32_MAX)), left.max };
+  case E::greaterEqual: return { std::max(left.min, right.min), left.max };
+  case E::smallerEqual: return { left.min, std::min(left.max, right.max) };
+  case E::equal:        return { std::max(left.min, right.min), std::min(left.max, right.max) };
+  default:              return left.isConstant() && right.isConstant() && left.min == right.min ? interval{ 1, 0 } : left;
+  }
+}
+valueRanges::interval valueRanges::at(size_t net, size_t slot)
+{
+  signalValues::bits const& bits = possible[net];
+  if (!(bits[slot / 64] >> (slot % 64) & 1))
+    return {};
+  size_t rank = popCount(bits[slot / 64] & ((uint64_t(1) << (slot % 64)) - 1));
+  for (size_t w = 0; w < slot / 64; w++)
+    rank += popCount(bits[w]);
+  return ranges[net][rank];
+}
+void valueRanges::evaluate(size_t s, std::vector<interval>& out)
+{
+  network::source const& source = network::source::list[s];
+  auto accumulate = [&out](size_t slot, interval const& value) { out[slot] = add(out[slot], value); };
+  if (source.flags & network::source::isConCom)
+  {
+    for (auto const& osv : source.cCombinator)
+      if (osv.has_value())
+        accumulate(osv.value().sig.description->slot, { osv.value().value, osv.value().value });
+    return;
+  }
+  auto input = [s](size_t slot)
+  {
+    interval result = {};
+    for (uint32_t in : { graph::red[s], graph::green[s] })
+      if (in != graph::none)
+        result = add(result, at(in, slot));
+    return result;
+  };
+  std::vector<size_t> inputSlots;
+  signalValues::bits inputs = {};
+  for (uint32_t in : { graph::red[s], graph::green[s] })
+    if (in != graph::none)
+      for (size_t w = 0; w < signalValues::words; w++)
+        inputs[w] |= possible[in][w];
+  for (size_t w = 0; w < signalValues::words; w++)
+    for (uint64_t bits = inputs[w]; bits; bits &= bits - 1)
+      inputSlots.push_back(w * 64 + lowestBit(bits));
+  auto operand = [&input](auto const& variant) -> interval
+  {
+    if (int32_t const* i = std::get_if<int32_t>(&variant))
+      return { *i, *i };
+    if (signal const* s = std::get_if<signal>(&variant))
+      return input(s->description->slot);
+    return {};
+  };
+
+  if (source.flags & network::source::isAriCom)
+  {
+    ariComData const& ari = source.aCombinator;
+    auto mode = static_cast<ariComData::Mode::Enum>(ari.mode.description->index);
+    interval right = operand(ari.right);
+    if (!std::holds_alternative<Each>(ari.left))
+      return accumulate(std::get<signal>(ari.output).description->slot, calculate(mode, operand(ari.left), right));
+    interval sum = {};
+    for (size_t slot : inputSlots)
+    {
+      interval value = hull({}, calculate(mode, input(slot), right)); // absent signals aren't calculated
+      if (std::holds_alternative<Each>(ari.output))
+        accumulate(slot, value);
+      else
+        sum = add(sum, value);
+    }
+    if (signal const* output = std::get_if<signal>(&ari.output))
+      accumulate(output->description->slot, sum);
+    return;
+  }
+  deciComData const& deci = source.dCombinator;
+  auto mode = static_cast<deciComData::Mode::Enum>(deci.mode.description->index);
+  interval right = operand(deci.right);
+  interval one = deci.value.has_value() ? interval{ std::min(0, deci.value.value()), std::max(0, deci.value.value()) } : interval{};
+  if (std::holds_alternative<Each>(deci.left))
+  {
+    interval sum = {};
+    for (size_t slot : inputSlots)
+    {
+      interval in = input(slot);
+      if (decide(mode, in, right) == 0)
+        continue;
+      interval value = deci.value.has_value() ? one : hull({}, restrict(mode, in, right));
+      if (std::holds_alternative<Each>(deci.output))
+        accumulate(slot, value);
+      else
+        sum = add(sum, value);
+    }
+    if (signal const* output = std::get_if<signal>(&deci.output))
+      accumulate(output->description->slot, sum);
+    return;
+  }
+  int decision = -1;
+  signal const* left = std::get_if<signal>(&deci.left);
+  interval condition = {};
+  if (left != nullptr)
+  {
+    condition = input(left->description->slot);
+    decision = decide(mode, condition, right);
+    condition = restrict(mode, condition, right);
+  }
+  if (decision == 0)
+    return;
+  auto value = [&](size_t slot) -> interval
+  {
+    if (deci.value.has_value())
+      return decision == 1 ? interval{ deci.value.value(), deci.value.value() } : one;
+    if (left != nullptr && left->description->slot == slot)
+      return hull({}, condition);
+    return input(slot);
+  };
+  if (signal const* output = std::get_if<signal>(&deci.output))
+    accumulate(output->description->slot, value(output->description->slot));
+  else
+    for (size_t slot : inputSlots)
+      accumulate(slot, deci.value.has_value() ? one : value(slot));
+}
+
+void valueRanges::run()
+{
+  removed = 0;
+  possible.clear();
+  ranges.clear();
+  if (!enabled)
+    return;
+  possible = possibleSignals();
+  ranges.resize(network::list.size());
+  for (size_t n = 0; n < network::list.size(); n++)
+  {
+    size_t count = 0;
+    for (uint64_t w : possible[n])
+      count += popCount(w);
+    ranges[n].assign(count, interval{});
+  }
+
+  // the values of a network for the current ranges of its inputs, always including the initial 0
+  std::vector<interval> sums(signalValues::size);
+  auto next = [&sums](size_t n)
+  {
+    std::fill(sums.begin(), sums.end(), interval{});
+    for (uint32_t s : graph::writers[n])
+      evaluate(s, sums);
+    std::vector<interval> result;
+    for (size_t w = 0; w < signalValues::words; w++)
+      for (uint64_t bits = possible[n][w]; bits; bits &= bits - 1)
+        result.push_back(hull({}, sums[w * 64 + lowestBit(bits)]));
+    return result;
+  };
+
+  // ascending iterations with widening, so that feedback loops terminate, which join every new result with the last one
+  std::vector<size_t> updates(network::list.size(), 0);
+  std::vector<uint8_t> isPending(network::list.size(), 1);
+  std::vector<size_t> pending(network::list.size());
+  for (size_t n = 0; n < pending.size(); n++)
+    pending[n] = pending.size() - 1 - n;
+  while (!pending.empty())
+  {
+    size_t n = pending.back();
+    pending.pop_back();
+    isPending[n] = 0;
+    std::vector<interval> result = next(n);
+    bool changed = false;
+    for (size_t i = 0; i < result.size(); i++)
+    {
+      interval joined = hull(ranges[n][i], result[i]);
+      if (joined == ranges[n][i])
+        continue;
+      if (updates[n] >= 3)
+      {
+        if (joined.min < ranges[n][i].min)
+          joined.min = INT32_MIN;
+        if (joined.max > ranges[n][i].max)
+          joined.max = INT32_MAX;
+      }
+      ranges[n][i] = joined;
+      changed = true;
+    }
+    if (!changed)
+      continue;
+    updates[n]++;
+    for (uint32_t reader : graph::readers[n])
+      for (uint32_t out : graph::outputs[reader])
+        if (!isPending[out])
+        {
+          isPending[out] = 1;
+          pending.push_back(out);
+        }
+  }
+  // descending iterations win back the precision that widening gave away, e.g. the limit of a counter
+  for (size_t round = 0; round < 4; round++)
+    for (size_t n = 0; n < network::list.size(); n++)
+      ranges[n] = next(n);
+
+  // combinators whose output is 0 on every tick
+  std::vector<network::source>& sources = network::source::list;
+  size_t relevantBefore = countOutputRelevant();
+  for (size_t n = 0; n < network::list.size(); n++)
+  {
+    network& net = network::list[n];
+    if (!(net.flags & network::isOutputRelevant))
+      continue;
+    std::vector<size_t> silent;
+    for (pointer<network::source> const& ps : net.sources)
+    {
+      if (!(sources[ps.index].flags & network::source::isDeciOrAri))
+        continue;
+      std::fill(sums.begin(), sums.end(), interval{});
+      evaluate(ps.index, sums);
+      if (std::all_of(sums.begin(), sums.end(), [](interval const& i) { return i.min == 0 && i.max == 0; }))
+        silent.push_back(ps.index);
+    }
+    if (silent.empty() || (silent.size() == net.sources.size() && (net.flags & network::isMainOutput)))
+      continue; // the output of the blueprint needs an entity to connect to
+    for (size_t s : silent)
+      setFlag(sources[s].flags, network::source::isEliminated);
+    net.sources.erase(std::remove_if(net.sources.begin(), net.sources.end(), [&silent](pointer<network::source> const& ps)
+    {
+      return std::find(silent.begin(), silent.end(), ps.index) != silent.end();
+    }), net.sources.end());
+    if (net.sources.empty())
+      // an empty network reads the same as no network
+      for (uint32_t reader : graph::readers[n])
+      {
+        if (!(sources[reader].flags & network::source::isDeciOrAri))
+          continue; // folded into a constant combinator
+        if (graph::red[reader] == n)
+          sources[reader].redInput = nullptr;
+        if (graph::green[reader] == n)
+          sources[reader].greenInput = nullptr;
+      }
+  }
+  dropUnusedTargets();
+  flagAllForOutput();
+  graph::freeze();
+  removed = relevantBefore - countOutputRelevant();
+}
+valueRanges::interval valueRanges::of(pointer<network> const& net, signal const& s)
+{
+  assert(!ranges.empty() && "value ranges are computed by compile()!");
+  return at(graph::networkOf[net.index], s.description->slot);
+}
+uint8_t valueRanges::bitsNeeded(pointer<network> const& net, signal const& s)
+{
+  interval range = of(net, s);
+  uint8_t bits = 1;
+  while (bits < 32 && (range.min < -(int64_t(1) << (bits - 1)) || range.max > (int64_t(1) << (bits - 1)) - 1))
+    bits++;
+  return bits;
+}
+std::string valueRanges::report()
+{
+  std::ostringstream out;
+  size_t constant = 0, boolean = 0, bounded = 0, total = 0;
+  for (size_t n = 0; n < ranges.size(); n++)
+    for (interval const& range : ranges[n])
+    {
+      total++;
+      constant += range.isConstant();
+      boolean += !range.isConstant() && range.isBoolean();
+      bounded += !range.isConstant() && !range.isBoolean() && range != full();
+    }
+  out << total << " (network, signal) pairs: " << constant << " constant, " << boolean << " boolean, " << bounded << " bounded, "
+      << total - constant - boolean - bounded << " unbounded, " << removed << " combinators removed\n";
+  for (size_t n = 0; n < ranges.size(); n++)
+  {
+    if (ranges[n].empty() || !(network::list[n].flags & network::isOutputRelevant))
+      continue;
+    out << "  network " << n << ":";
+    size_t i = 0;
+    for (size_t w = 0; w < signalValues::words; w++)
+      for (uint64_t bits = possible[n][w]; bits; bits &= bits - 1, i++)
+        out << " " << signalValues::signalAt(w * 64 + lowestBit(bits)).description->codeSyntax << " [" << ranges[n][i].min << ", " << ranges[n][i].max << "]";
+    out << "\n";
+  }
+  return out.str();
+}
+
+// writes the blueprint string while the json is generated: the text is deflated and base64 encoded one chunk at a time,
+// so that neither the whole json nor the whole compressed data is ever held in memory
+struct blueprintWriter
+{
+  static constexpr size_t chunk = 1 << 16;
+
+  z_stream stream = {};
+  std::vector<char> text = std::vector<char>(chunk);
+  size_t length = 0;
+  std::vector<uint8_t> deflated = std::vector<uint8_t>(chunk);
+  std::array<uint8_t, 3> carry;  // compressed bytes waiting for a full group of three
+  size_t carried = 0;
+  char pending = 0;              // opening bracket or comma that is only written once it is followed by something else
+  std::string result = "0";
+
+  blueprintWriter();
+  ~blueprintWriter();
+  blueprintWriter(blueprintWriter const&) = delete;
+  blueprintWriter& operator=(blueprintWriter const&) = delete;
+
+  // lists are written with a comma after every element and close() takes the place of the last comma
+  // an empty list closes onto its own opening bracket, as the stream based writer did by seeking back over it
+  void open(char bracket) { this->write(); this->pending = bracket; }
+  void comma() { this->write(); this->pending = ','; }
+  void close(char bracket) { this->pending = 0; this->put(bracket); }
+
+  void write()
+  {
+    if (this->pending != 0)
+    {
+      char c = this->pending;
+      this->pending = 0;
+      this->put(c);
+    }
+  }
+  void put(char c)
+  {
+    if (this->length == chunk)
+      this->flush(false);
+    this->text[this->length++] = c;
+  }
+  void put(char const* s, size_t size);
+  char* reserve(size_t size)
+  {
+    if (this->length + size > chunk)
+      this->flush(false);
+    return &this->text[this->length];
+  }
+  void flush(bool finish);
+  void encode(uint8_t const* data, size_t size);
+  std::string finish();
+};
+blueprintWriter::blueprintWriter()
+{
+  switch (deflateInit(&this->stream, 9))
+  {
+  case Z_OK: break;
+  case Z_MEM_ERROR: throw std::runtime_error("Compression failed: not enough memory.");
+  case Z_STREAM_ERROR: throw std::runtime_error("Invalid compression level: 9.");
+  default:
+    throw std::runtime_error("Compression failed: unknown error.");
+  }
+}
+blueprintWriter::~blueprintWriter()
+{
+  deflateEnd(&this->stream);
+}
+void blueprintWriter::put(char const* s, size_t size)
+{
+  this->write();
+  while (size != 0)
+  {
+    if (this->length == chunk)
+      this->flush(false);
+    size_t part = std::min(size, chunk - this->length);
+    std::memcpy(&this->text[this->length], s, part);
+    this->length += part;
+    s += part;
+    size -= part;
+  }
+}
+void blueprintWriter::flush(bool finish)
+{
+  this->stream.next_in = reinterpret_cast<Bytef*>(this->text.data());
+  this->stream.avail_in = static_cast<uInt>(this->length);
+  do
+  {
+    this->stream.next_out = this->deflated.data();
+    this->stream.avail_out = static_cast<uInt>(chunk);
+    auto code = deflate(&this->stream, finish ? Z_FINISH : Z_NO_FLUSH);
+    assert(code != Z_STREAM_ERROR && "deflate stream got corrupted");
+    this->encode(this->deflated.data(), chunk - this->stream.avail_out);
+  } while (this->stream.avail_out == 0);
+  assert(this->stream.avail_in == 0 && "deflate left input behind");
+  this->length = 0;
+}
+static const std::array<const char, 64> base64Chars =
+{
+  'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
+  'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f',
+  'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v',
+  'w', 'x', 'y', 'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'
+};
+void blueprintWriter::encode(uint8_t const* data, size_t size)
+{
+  for (; this->carried != 0 && this->carried < 3 && size != 0; size--)
+    this->carry[this->carried++] = *data++;
+  if (this->carried == 3)
+  {
+    this->carried = 0;
+    this->encode(this->carry.data(), 3);
+  }
+  size_t whole = size - size % 3;
+  size_t start = this->result.size();
+  this->result.resize(start + whole / 3 * 4);
+  char* out = &this->result[start];
+  for (size_t i = 0; i < whole; i += 3, out += 4)
+  {
+    uint32_t bits = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+    out[0] = base64Chars[ bits >> 18            ];
+    out[1] = base64Chars[(bits >> 12) & 0b111111];
+    out[2] = base64Chars[(bits >>  6) & 0b111111];
+    out[3] = base64Chars[(bits      ) & 0b111111];
+  }
+  for (size_t i = whole; i < size; i++)
+    this->carry[this->carried++] = data[i];
+}
+std::string blueprintWriter::finish()
+{
+  this->write();
+  this->flush(true);
+  uint32_t bits;
+  switch (this->carried)
+  {
+  case 2:
+    bits = (this->carry[0] << 8) | this->carry[1];
+    this->result.append(1, base64Chars[ bits >> 10            ]);
+    this->result.append(1, base64Chars[(bits >>  4) & 0b111111]);
+    this->result.append(1, base64Chars[(bits <<  2) & 0b111111]);
+    this->result.append(1, '=');
+    break;
+  case 1:
+    bits = this->carry[0];
+    this->result.append(1, base64Chars[ bits >> 2            ]);
+    this->result.append(1, base64Chars[(bits << 4) & 0b111111]);
+    this->result.append(2, '=');
+    break;
+  }
+  this->carried = 0;
+  assert((this->result.size() - 1) % 4 == 0 && "base64 is written in groups of four characters");
+  return std::move(this->result);
+}
+
+blueprintWriter& operator<<(blueprintWriter& out, char c) { out.write(); out.put(c); return out; }
+blueprintWriter& operator<<(blueprintWriter& out, char const* s) { out.put(s, std::strlen(s)); return out; }
+blueprintWriter& operator<<(blueprintWriter& out, std::string const& s) { out.put(s.data(), s.size()); return out; }
+template<class T, std::enable_if_t<std::is_integral_v<T>, int> = 0> blueprintWriter& operator<<(blueprintWriter& out, T i)
+{
+  out.write();
+  char* at = out.reserve(24);
+  out.length += std::to_chars(at, at + 24, i).ptr - at;
+  return out;
+}
+blueprintWriter& operator<<(blueprintWriter& out, float f) // as an ostream with default flags prints it
+{
+  out.write();
+  float twice = f * 2;
+  if (std::abs(f) < 100000 && twice == std::floor(twice)) // positions are on the half tile
+  {
+    if (std::signbit(f))
+      out.put('-');
+    uint32_t halves = static_cast<uint32_t>(std::abs(twice));
+    out << halves / 2;
+    if (halves % 2)
+      out.put(".5", 2);
+    return out;
+  }
+  char* at = out.reserve(32);
+  out.length += std::snprintf(at, 32, "%g", static_cast<double>(f));
+  return out;
+}
+blueprintWriter& operator<<(blueprintWriter& out, Any const&) { return out << "{\"type\":\"virtual\",\"name\":\"signal-anything\"}"; }
+blueprintWriter& operator<<(blueprintWriter& out, All const&) { return out << "{\"type\":\"virtual\",\"name\":\"signal-everything\"}"; }
+blueprintWriter& operator<<(blueprintWriter& out, Each const&) { return out << "{\"type\":\"virtual\",\"name\":\"signal-each\"}"; }
+blueprintWriter& operator<<(blueprintWriter& out, signal const& s) 
+{
+  return out << "{\"type\":\"" << s.description->type << "\",\"name\":\"" << s.description->gameSyntax << "\"}"; 
+}
+blueprintWriter& operator<<(blueprintWriter& out, signal::WithValue const& sv) 
+{
+  return out << "\"signal\":" << sv.sig << ",\"count\":" << sv.value;
+}
+blueprintWriter& operator<<(blueprintWriter& out, conComData const& c) 
+{
+  out << "constant-combinator\",\"control_behavior\":{\"filters\":";
+  out.open('[');
+  for (size_t j = 0; j < c.size(); j++)
+    if (c[j].has_value())
+    {
+      out << "{" << c[j].value() << ",\"index\":" << (j + 1) << "}";
+      out.comma();
+    }
+  out.close(']');
+  return out << "},";
+}
+blueprintWriter& operator<<(blueprintWriter& out, deciComData const& d) 
+{
+  out << "decider-combinator\",\"control_behavior\":{\"decider_conditions\":{\"first_signal\":";
+  std::visit([&out](auto const& l) -> blueprintWriter& { return out << l; }, d.left) << ",";
+  std::visit(overload(
+    [&out](int32_t const& i) { out << "\"constant\":" << i; },
+    [&out](signal const& s) { out << "\"second_signal\":" << s << ""; }
+  ), d.right);
+  out << ",\"comparator\":\"" << d.mode.description->gameSyntax << "\",\"output_signal\":";
+  std::visit([&out](auto const& l) -> blueprintWriter& { return out << l; }, d.output);
+  return out << ",\"copy_count_from_input\":" << (d.value.has_value() ? "false}}," : "true}},");
+}
+blueprintWriter& operator<<(blueprintWriter& out, ariComData const& a) 
+{
+  out << "arithmetic-combinator\",\"control_behavior\":{\"arithmetic_conditions\":{";
+  std::visit(overload(
+    [&out](int32_t const& i) { out << "\"first_constant\":" << i << ","; },
+    [&out](auto const& s) { out << "\"first_signal\":" << s << ","; }
+  ), a.left);
+  std::visit(overload(
+    [&out](int32_t const& i) { out << "\"second_constant\":" << i << ","; },
+    [&out](signal const& s) { out << "\"second_signal\":" << s << ","; }
+  ), a.right);
+  out << "\"operation\":\"" << a.mode.description->gameSyntax << "\",\"output_signal\":";
+  return std::visit([&out](auto const& l) -> blueprintWriter& { return out << l; }, a.output) << "}},";
+}
+blueprintWriter& operator<<(blueprintWriter& out, std::tuple<pointer<entity>, connectionType> const& connector) 
+{
+  const auto [first, second] = connector;
+  out << "{\"entity_id\":" << first.index + 1;
+  if (second != connectionType::standard)
+    out << ",\"circuit_id\":" << static_cast<int>(second);
+  return out << "}";
+}
+template<class T> blueprintWriter& operator<<(blueprintWriter& out, std::vector<T> const& vec)
+{
+  out.open('[');
+  for (auto& el : vec)
+  {
+    out << el;
+    out.comma();
+  }
+  out.close(']');
+  return out;
+}
+blueprintWriter& operator<<(blueprintWriter& out, entity const& e)
+{
+  out << "{\"entity_number\":" << (&e - &entity::list[0] + 1) << ",\"position\":{\"x\":" << std::get<0>(e.position) << ",\"y\":" << -std::get<1>(e.position) << "},";
+  if (e.direction != 0)
+    out << "\"direction\":" << e.direction << ",";
+  out << "\"name\":\"";
+  if (e.source == nullptr)
+    out << "medium-electric-pole\",";
+  else
+    switch (e.source->flags & (network::source::isDeciOrAri | network::source::isConCom))
+    {
+    case network::source::isConCom:  out << e.source->cCombinator; break;
+    case network::source::isDeciCom: out << e.source->dCombinator; break;
+    case network::source::isAriCom:  out << e.source->aCombinator; break;
+    }
+  out << "\"connections\":";
+  out.open('{');
+  for (size_t i = 0; i < e.rConnection.size(); i++)
+  {
+    out << "\"" << (i + 1) << "\":{";
+    if (e.rConnection[i].size() != 0)
+    {
+      out << "\"red\":" << e.rConnection[i];
+      if (e.gConnection[i].size() != 0)
+        out << ",\"green\":" << e.gConnection[i];
+    }
+    else
+      out << "\"green\":" << e.gConnection[i];
+    out << "}";
+    out.comma();
+  }
+  out.close('}');
+  return out << "}";
+}
+std::string stringify()
+{
+  blueprintWriter out;
+  out << "{\"blueprint\":{\"icons\":[{\"signal\":" << itemSignal::decider_combinator << ",\"index\":1}],"
+      << "\"entities\":" << entity::list << ",\"item\":\"blueprint\",\"version\":73018310664}}";
+  return out.finish();
+}
+
+// pull parser over the inflated json of a blueprint, which hands out views into the text instead of building a tree
+// the lists the writer leaves empty close onto their opening bracket, which is accepted so that compile() output reads back
+struct jsonReader
+{
+  char const* begin;
+  char const* at;
+  char const* end;
+
+  [[noreturn]] static void fail(std::string const& what) { throw std::runtime_error("Blueprint import failed: " + what); }
+  char peek()
+  {
+    while (this->at != this->end && (*this->at == ' ' || *this->at == '\n' || *this->at == '\r' || *this->at == '\t'))
+      this->at++;
+    return this->at == this->end ? 0 : *this->at;
+  }
+  bool consume(char c)
+  {
+    if (this->peek() != c)
+      return false;
+    this->at++;
+    return true;
+  }
+  void expect(char c)
+  {
+    if (!this->consume(c))
+      fail(std::string("expected '") + c + "' at offset " + std::to_string(this->at - this->begin) + ".");
+  }
+  std::string_view string() // escapes are skipped but not decoded, names of signals and entities have none, see unescape()
+  {
+    this->expect('"');
+    char const* first = this->at;
+    while (true)
+    {
+      char const* quote = static_cast<char const*>(std::memchr(this->at, '"', this->end - this->at));
+      if (quote == nullptr)
+        fail("unterminated string.");
+      this->at = quote + 1;
+      size_t backslashes = 0;
+      while (quote - backslashes != first && quote[-1 - static_cast<ptrdiff_t>(backslashes)] == '\\')
+        backslashes++;
+      if (backslashes % 2 == 0)
+        return std::string_view(first, quote - first);
+    }
+  }
+  static std::string unescape(std::string_view s) // for the comparators, which some exporters write as \u2265 and alike
+  {
+    std::string result;
+    for (size_t i = 0; i < s.size(); i++)
+    {
+      if (s[i] != '\\' || i + 1 == s.size())
+      {
+        result += s[i];
+        continue;
+      }
+      char c = s[++i];
+      if (c != 'u' || i + 4 >= s.size())
+      {
+        result += c == 'n' ? '\n' : c == 't' ? '\t' : c == 'r' ? '\r' : c == 'b' ? '\b' : c == 'f' ? '\f' : c;
+        continue;
+      }
+      uint32_t code = 0;
+      std::from_chars(s.data() + i + 1, s.data() + i + 5, code, 16);
+      i += 4;
+      if (code < 0x80)
+        result += static_cast<char>(code);
+      else if (code < 0x800)
+        result += { static_cast<char>(0xC0 | code >> 6), static_cast<char>(0x80 | (code & 0x3F)) };
+      else
+        result += { static_cast<char>(0xE0 | code >> 12), static_cast<char>(0x80 | (code >> 6 & 0x3F)), static_cast<char>(0x80 | (code & 0x3F)) };
+    }
+    return result;
+  }
+  int64_t integer()
+  {
+    this->peek();
+    int64_t result = 0;
+    auto [next, error] = std::from_chars(this->at, this->end, result);
+    if (error != std::errc())
+      fail("expected an integer.");
+    this->at = next;
+    if (this->at != this->end && (*this->at == '.' || *this->at == 'e' || *this->at == 'E'))
+      fail("expected an integer.");
+    return result;
+  }
+  bool boolean()
+  {
+    bool result = this->peek() == 't';
+    this->skip();
+    return result;
+  }
+  template<class F> void object(F const& onKey) // onKey(key) reads or skips the value of every key
+  {
+    this->expect('{');
+    if (this->consume('}'))
+      return;
+    do
+    {
+      std::string_view key = this->string();
+      this->expect(':');
+      onKey(key);
+    } while (this->consume(','));
+    this->expect('}');
+  }
+  template<class F> void array(F const& onElement)
+  {
+    if (this->consume(']'))
+      return;
+    this->expect('[');
+    if (this->consume(']'))
+      return;
+    do
+      onElement();
+    while (this->consume(','));
+    this->expect(']');
+  }
+  void skip()
+  {
+    switch (this->peek())
+    {
+    case '{': this->object([this](std::string_view) { this->skip(); }); break;
+    case '[': this->array([this]() { this->skip(); }); break;
+    case '"': this->string(); break;
+    case 0: fail("unexpected end of the json.");
+    default:
+      while (this->at != this->end && (std::isalnum(static_cast<unsigned char>(*this->at)) || *this->at == '-' || *this->at == '+' || *this->at == '.'))
+        this->at++;
+    }
+  }
+};
+
+// rebuilds the sources and networks of a blueprint string. Every constant, decider and arithmetic combinator becomes a source
+// and every set of circuit connectors joined by wires of one color becomes a network that the combinators write into
+// networks that reach other entities, like lamps or inserters, that end in a pole with a single wire, like the posts of
+// compile(), or that no combinator reads are the main outputs
+void importBlueprint(std::string const& blueprint)
+{
+  assert(network::simIndex == 0 && "cannot import into a circuit that is already compiled!");
+  size_t first = blueprint.find_first_not_of(" \t\r\n");
+  if (first == std::string::npos || blueprint[first] != '0')
+    jsonReader::fail("only blueprint strings of version 0 are supported.");
+
+  // base64, then inflate
+  std::array<int8_t, 256> value;
+  value.fill(-1);
+  for (size_t i = 0; i < base64Chars.size(); i++)
+    value[static_cast<uint8_t>(base64Chars[i])] = static_cast<int8_t>(i);
+  std::vector<uint8_t> compressed;
+  compressed.reserve((blueprint.size() - first) / 4 * 3);
+  uint32_t bits = 0;
+  size_t count = 0;
+  for (size_t i = first + 1; i < blueprint.size(); i++)
+  {
+    int8_t v = value[static_cast<uint8_t>(blueprint[i])];
+    if (v < 0)
+    {
+      if (blueprint[i] == '=' || std::isspace(static_cast<unsigned char>(blueprint[i])))
+        continue;
+      jsonReader::fail("invalid base64 character.");
+    }
+    bits = bits << 6 | v;
+    if (++count % 4 == 0)
+    {
+      compressed.push_back(static_cast<uint8_t>(bits >> 16));
+      compressed.push_back(static_cast<uint8_t>(bits >> 8));
+      compressed.push_back(static_cast<uint8_t>(bits));
+    }
+  }
+  if (count % 4 >= 2)
+    compressed.push_back(static_cast<uint8_t>(bits >> (count % 4 == 2 ? 4 : 10)));
+  if (count % 4 == 3)
+    compressed.push_back(static_cast<uint8_t>(bits >> 2));
+
+  std::string text;
+  z_stream stream = {};
+  if (inflateInit(&stream) != Z_OK)
+    throw std::runtime_error("Decompression failed: not enough memory.");
+  stream.next_in = compressed.data();
+  stream.avail_in = static_cast<uInt>(compressed.size());
+  int code = Z_OK;
+  while (code != Z_STREAM_END)
+  {
+    size_t used = text.size();
+    text.resize(std::max<size_t>(used * 2, compressed.size() * 8));
+    stream.next_out = reinterpret_cast<Bytef*>(&text[used]);
+    stream.avail_out = static_cast<uInt>(text.size() - used);
+    code = inflate(&stream, Z_NO_FLUSH);
+    text.resize(text.size() - stream.avail_out);
+    if (code != Z_OK && code != Z_STREAM_END)
+    {
+      inflateEnd(&stream);
+      throw std::runtime_error(code == Z_MEM_ERROR ? "Decompression failed: not enough memory." : "Decompression failed: the blueprint string is corrupted.");
+    }
+  }
+  inflateEnd(&stream);
+
+  // signals by their name in the game, wildcards are kept apart since the signal tables don't hold them
+  static std::unordered_map<std::string_view, signal::Description const*> const signalNamed = []()
+  {
+    std::unordered_map<std::string_view, signal::Description const*> result;
+    for (std::vector<signal> const* table : { &itemSignal::itemSignals, &fluidSignal::fluidSignals, &virtualSignal::virtualSignals })
+      for (signal const& s : *table)
+        result.emplace(s.description->gameSyntax, s.description);
+    return result;
+  }();
+  enum class operand : uint8_t { none, signal, any, all, each };
+  struct signalRef
+  {
+    operand kind = operand::none;
+    signal::Description const* description = nullptr;
+  };
+  struct parsedEntity
+  {
+    size_t number = 0;
+    std::string_view name;
+    size_t filters = graph::none; // index into constants, constant combinators without signals have none
+    signalRef left, right, output;
+    std::optional<int32_t> leftConstant, rightConstant;
+    std::string_view mode;
+    bool copyCount = true;
+    bool isOn = true;
+  };
+  struct parsedWire
+  {
+    size_t from, to;     // index into entities and entity number
+    uint8_t fromCircuit, toCircuit, c;
+  };
+  std::vector<parsedEntity> entities;
+  std::vector<conComData> constants;
+  std::vector<parsedWire> wires;
+
+  jsonReader json{ text.data(), text.data(), text.data() + text.size() };
+  auto readSignal = [&json]()
+  {
+    signalRef result;
+    json.object([&](std::string_view key)
+    {
+      if (key != "name")
+        return json.skip();
+      std::string_view name = json.string();
+      if (name == "signal-anything")
+        result.kind = operand::any;
+      else if (name == "signal-everything")
+        result.kind = operand::all;
+      else if (name == "signal-each")
+        result.kind = operand::each;
+      else if (auto found = signalNamed.find(name); found != signalNamed.end())
+        result = { operand::signal, found->second };
+      else
+        jsonReader::fail("unknown signal " + std::string(name) + ".");
+    });
+    return result;
+  };
+  auto readInt32 = [&json]()
+  {
+    int64_t i = json.integer();
+    if (i < INT32_MIN || i > INT32_MAX)
+      jsonReader::fail("value out of the 32 bit range.");
+    return static_cast<int32_t>(i);
+  };
+  auto readConditions = [&](parsedEntity& e)
+  {
+    json.object([&](std::string_view key)
+    {
+      if (key == "first_signal")
+        e.left = readSignal();
+      else if (key == "second_signal")
+        e.right = readSignal();
+      else if (key == "output_signal")
+        e.output = readSignal();
+      else if (key == "first_constant")
+        e.leftConstant = readInt32();
+      else if (key == "second_constant" || key == "constant")
+        e.rightConstant = readInt32();
+      else if (key == "comparator" || key == "operation")
+        e.mode = json.string();
+      else if (key == "copy_count_from_input")
+        e.copyCount = json.boolean();
+      else
+        json.skip();
+    });
+  };
+  auto readEntity = [&]()
+  {
+    parsedEntity& e = entities.emplace_back();
+    json.object([&](std::string_view key)
+    {
+      if (key == "entity_number")
+        e.number = static_cast<size_t>(json.integer());
+      else if (key == "name")
+        e.name = json.string();
+      else if (key == "control_behavior")
+        json.object([&](std::string_view key)
+        {
+          if (key == "filters")
+            json.array([&]()
+            {
+              std::optional<signal::WithValue> filter;
+              int64_t index = 0;
+              json.object([&](std::string_view key)
+              {
+                if (key == "signal")
+                {
+                  signalRef s = readSignal();
+                  if (s.kind != operand::signal)
+                    jsonReader::fail("constant combinators can't hold wildcards.");
+                  filter = signal::WithValue{ filter ? filter->value : 0, signal(const_cast<signal::Description*>(s.description)) };
+                }
+                else if (key == "count")
+                {
+                  int32_t count = readInt32();
+                  if (filter)
+                    filter->value = count;
+                  else
+                    filter = signal::WithValue{ count, signal(nullptr) };
+                }
+                else if (key == "index")
+                  index = json.integer();
+                else
+                  json.skip();
+              });
+              if (!filter || filter->sig.description == nullptr)
+                return;
+              // the game has slots past the 18 of conComData, whose signals move into free slots
+              if (e.filters == graph::none)
+              {
+                e.filters = constants.size();
+                constants.emplace_back();
+              }
+              conComData& slots = constants[e.filters];
+              size_t slot = index >= 1 && index <= static_cast<int64_t>(slots.size()) && !slots[index - 1] ? index - 1 : 0;
+              while (slot < slots.size() && slots[slot])
+                slot++;
+              if (slot == slots.size())
+                jsonReader::fail("constant combinator with more than " + std::to_string(slots.size()) + " signals.");
+              slots[slot] = filter;
+            });
+          else if (key == "decider_conditions" || key == "arithmetic_conditions")
+            readConditions(e);
+          else if (key == "is_on")
+            e.isOn = json.boolean();
+          else
+            json.skip();
+        });
+      else if (key == "connections")
+        json.object([&](std::string_view circuit)
+        {
+          if (circuit != "1" && circuit != "2")
+            return json.skip(); // copper wires of power switches
+          json.object([&](std::string_view c)
+          {
+            if (c != "red" && c != "green")
+              return json.skip();
+            json.array([&]()
+            {
+              parsedWire w = { entities.size() - 1, 0, static_cast<uint8_t>(circuit[0] - '0'), 1, static_cast<uint8_t>(c == "red" ? color::r : color::g) };
+              json.object([&](std::string_view key)
+              {
+                if (key == "entity_id")
+                  w.to = static_cast<size_t>(json.integer());
+                else if (key == "circuit_id")
+                  w.toCircuit = static_cast<uint8_t>(json.integer());
+                else
+                  json.skip();
+              });
+              if (w.toCircuit != 1 && w.toCircuit != 2)
+                jsonReader::fail("circuit connector " + std::to_string(w.toCircuit) + " doesn't exist.");
+              wires.push_back(w);
+            });
+          });
+        });
+      else
+        json.skip();
+    });
+  };
+  json.object([&](std::string_view key)
+  {
+    if (key == "blueprint_book")
+      jsonReader::fail("blueprint books are not supported.");
+    if (key != "blueprint")
+      return json.skip();
+    json.object([&](std::string_view key)
+    {
+      if (key == "entities")
+        json.array(readEntity);
+      else
+        json.skip();
+    });
+  });
+  if (json.peek() != 0)
+    jsonReader::fail("trailing characters after the json.");
+
+  // connectors are node (entity * 2 + circuit - 1) * 2 + color, joined by a union-find over the wires
+  std::unordered_map<size_t, size_t> entityOf; // entity numbers come from the input, so they can be anything
+  entityOf.reserve(entities.size());
+  for (size_t i = 0; i < entities.size(); i++)
+    if (!entityOf.emplace(entities[i].number, i).second)
+      jsonReader::fail("entity number " + std::to_string(entities[i].number) + " appears twice.");
+  auto nodeOf = [](size_t entity, uint8_t circuit, uint8_t c) { return (entity * 2 + circuit - 1) * 2 + c; };
+  std::vector<size_t> parent(entities.size() * 4);
+  std::vector<uint8_t> isWired(parent.size(), 0);
+  std::vector<uint32_t> wiresFrom(parent.size(), 0); // as listed by the connector itself
+  for (size_t n = 0; n < parent.size(); n++)
+    parent[n] = n;
+  auto find = [&parent](size_t n)
+  {
+    while (parent[n] != n)
+      n = parent[n] = parent[parent[n]];
+    return n;
+  };
+  for (parsedWire const& w : wires)
+  {
+    auto target = entityOf.find(w.to);
+    if (target == entityOf.end())
+      jsonReader::fail("wire to the missing entity " + std::to_string(w.to) + ".");
+    size_t from = nodeOf(w.from, w.fromCircuit, w.c), to = nodeOf(target->second, w.toCircuit, w.c);
+    isWired[from] = isWired[to] = 1;
+    wiresFrom[from]++;
+    parent[find(from)] = find(to);
+  }
+
+  // sources in the order of the entities, each writing into the network of its output connector of either color
+  enum class kind : uint8_t { other, pole, constant, decider, arithmetic };
+  auto kindOf = [](std::string_view name)
+  {
+    if (name == "constant-combinator")   return kind::constant;
+    if (name == "decider-combinator")    return kind::decider;
+    if (name == "arithmetic-combinator") return kind::arithmetic;
+    if (name == "small-electric-pole" || name == "medium-electric-pole" || name == "big-electric-pole" || name == "substation")
+      return kind::pole;
+    return kind::other;
+  };
+  // combinators without a left operand or without an output signal don't output anything in the game
+  auto outputs = [](parsedEntity const& e, kind k)
+  {
+    if (k == kind::constant)
+      return true;
+    if (k == kind::other || k == kind::pole)
+      return false;
+    return !(e.left.kind == operand::none && (k == kind::decider || !e.leftConstant)) && e.output.kind != operand::none;
+  };
+  // inputs wired only to chests, lamps and the like read nothing, so they don't get a network without any source
+  std::vector<uint8_t> isWritten(parent.size(), 0); // of every root
+  for (size_t i = 0; i < entities.size(); i++)
+    if (kind k = kindOf(entities[i].name); outputs(entities[i], k))
+      for (size_t node = k == kind::constant ? i * 4 : i * 4 + 2, last = node + 2; node < last; node++)
+        if (isWired[node])
+          isWritten[find(node)] = 1;
+  std::vector<size_t> networkAt(parent.size(), graph::none); // network id of every root
+  auto networkOf = [&](size_t node)
+  {
+    size_t root = find(node);
+    if (networkAt[root] == graph::none)
+    {
+      network::list.emplace_back(network{ {}, network::newId(), {}, node % 2 == 0 ? color::r : color::g, network::isCompleted });
+      networkAt[root] = network::list.back().id;
+    }
+    return pointer<network>(networkAt[root]);
+  };
+  for (size_t i = 0; i < entities.size(); i++)
+  {
+    parsedEntity const& e = entities[i];
+    kind k = kindOf(e.name);
+    if (!outputs(e, k))
+      continue;
+    network::source next(e.isOn && e.filters != graph::none ? constants[e.filters] : conComData{});
+    size_t output = k == kind::constant ? i * 4 : i * 4 + 2; // first node of the output connector
+    if (k != kind::constant)
+    {
+      auto toSignal = [](signalRef const& s)
+      {
+        if (s.description == nullptr)
+          jsonReader::fail("wildcard where the game doesn't allow one.");
+        return signal(const_cast<signal::Description*>(s.description));
+      };
+      auto modeNamed = [&e](auto const& modes)
+      {
+        std::string name = jsonReader::unescape(e.mode);
+        for (auto const& mode : modes)
+          if (name == mode.description->gameSyntax || name == mode.description->codeSyntax)
+            return mode;
+        jsonReader::fail("unknown operation " + name + ".");
+      };
+      next.flags = k == kind::decider ? network::source::isDeciCom : network::source::isAriCom;
+      if (k == kind::decider)
+      {
+        deciComData::Input::Left left = e.left.kind == operand::any ? deciComData::Input::Left(any)
+                                      : e.left.kind == operand::all ? deciComData::Input::Left(all)
+                                      : e.left.kind == operand::each ? deciComData::Input::Left(each)
+                                      : deciComData::Input::Left(toSignal(e.left));
+        deciComData::Input::Right right = e.right.kind == operand::signal ? deciComData::Input::Right(toSignal(e.right)) : deciComData::Input::Right(e.rightConstant.value_or(0));
+        deciComData::Output::Type output = e.output.kind == operand::all ? deciComData::Output::Type(all)
+                                         : e.output.kind == operand::each ? deciComData::Output::Type(each)
+                                         : deciComData::Output::Type(toSignal(e.output));
+        next.dCombinator = deciComData{ left, right, modeNamed(deciComData::Mode::modes), output, e.copyCount ? input : deciComData::Output::Value(1) };
+      }
+      else
+      {
+        ariComData::Input::Left left = e.left.kind == operand::each ? ariComData::Input::Left(each)
+                                     : e.left.kind == operand::signal ? ariComData::Input::Left(toSignal(e.left))
+                                     : ariComData::Input::Left(e.leftConstant.value_or(0));
+        ariComData::Input::Right right = e.right.kind == operand::signal ? ariComData::Input::Right(toSignal(e.right)) : ariComData::Input::Right(e.rightConstant.value_or(0));
+        ariComData::Output output = e.output.kind == operand::each ? ariComData::Output(each) : ariComData::Output(toSignal(e.output));
+        next.aCombinator = ariComData{ left, right, modeNamed(ariComData::Mode::modes), output };
+      }
+      next.redInput = next.greenInput = nullptr;
+      if (isWired[i * 4] && isWritten[find(i * 4)])
+        next.redInput = networkOf(i * 4);
+      if (isWired[i * 4 + 1] && isWritten[find(i * 4 + 1)])
+        next.greenInput = networkOf(i * 4 + 1);
+      next.resolve();
+    }
+    size_t s = network::source::list.size();
+    for (size_t node = output; node < output + 2; node++)
+      if (isWired[node])
+        networkOf(node)->sources.emplace_back(s);
+    if (next.flags & network::source::isDeciOrAri)
+      for (pointer<network> const& in : { next.redInput, next.greenInput })
+        if (in.index != -1)
+          in->targets.emplace_back(s);
+    network::source::list.emplace_back(next);
+  }
+
+  for (size_t i = 0; i < entities.size(); i++)
+    if (kind k = kindOf(entities[i].name); k == kind::other || k == kind::pole)
+      for (size_t node = i * 4; node < i * 4 + 4; node++)
+        if (isWired[node] && networkAt[find(node)] != graph::none && (k == kind::other || wiresFrom[node] == 1))
+          pointer<network>(networkAt[find(node)])->markAsOutput();
+  for (network& net : network::list)
+    if (net.targets.empty())
+      net.markAsOutput();
+}
+
+// detects when the state of all networks repeats, which clocks and counters settle into, so that long simulations can skip ahead
+// every tick the network hashes are updated, all of them after run() and those whose values changed after runEventDriven(), and repeats
+// of the combined hash are found with brent's cycle detection
+// matches of the hash are confirmed against a copy of the values taken at the checkpoint, so hash collisions can't cause skips
+struct steadyState
+{
+  static bool enabled;           // opt-in, because hashing adds roughly a fifth to the cost of a tick, call reset() after turning it on
+  static thread_local uint64_t tick;          // ticks simulated since compiling
+  static thread_local uint64_t hash;          // of the latest values of all networks
+  static thread_local uint64_t period;        // 0 while no repeating state has been found
+  static thread_local uint64_t periodFoundAt; // tick at which the period was found, the state has been periodic since at least periodFoundAt - period
+
+  static void reset();                   // forgets the period, which is needed after changing the circuit's inputs
+  static void rehash();                  // after all networks got new values
+  static void rehash(size_t net);        // after network::list[net] got new values
+  static void advance(bool historyRecorded);
+  static uint64_t skip(uint64_t ticks);  // skips up to ticks ticks without simulating them and returns how many were skipped
+
+  static thread_local uint64_t checkpoint, power, distance, historyStart;
+  static thread_local std::vector<uint64_t> networkHashes;
+  static thread_local std::vector<uint64_t> snapshot;      // values of all networks at the checkpoint as slot << 32 | value
+  static thread_local std::vector<uint32_t> snapshotBegin; // network n's values are snapshot[snapshotBegin[n], snapshotBegin[n + 1])
+
+  static uint64_t mix(uint64_t x);
+  static uint64_t hashOf(signalValues const& values);
+  static void takeSnapshot();
+  static bool matchesSnapshot();
+};
+bool steadyState::enabled = false;
+thread_local uint64_t steadyState::tick = 0;
+thread_local uint64_t steadyState::hash = 0;
+thread_local uint64_t steadyState::period = 0;
+thread_local uint64_t steadyState::periodFoundAt = 0;
+thread_local uint64_t steadyState::checkpoint = 0;
+thread_local uint64_t steadyState::power = 1;
+thread_local uint64_t steadyState::distance = 0;
+thread_local uint64_t steadyState::historyStart = 0;
+thread_local std::vector<uint64_t> steadyState::networkHashes;
+thread_local std::vector<uint64_t> steadyState::snapshot;
+thread_local std::vector<uint32_t> steadyState::snapshotBegin;
+
+uint64_t steadyState::mix(uint64_t x) // splitmix64 finalizer
+{
+  x += 0x9e3779b97f4a7c15;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+  return x ^ (x >> 31);
+}
+void steadyState::reset()
+{
+  rehash();
+  period = 0;
+  checkpoint = hash;
+  takeSnapshot();
+  power = 1;
+  distance = 0;
+}
+uint64_t steadyState::hashOf(signalValues const& values)
+{
+  uint64_t h = 0;
+  values.forEach([&h](size_t slot, int32_t value) { h += mix(uint64_t(slot) << 32 | static_cast<uint32_t>(value)); });
+  return h;
+}
+void steadyState::rehash()
+{
+  if (!enabled || network::simIndex == 0) // the values only exist after compiling
+    return;
+  networkHashes.resize(network::list.size());
+  hash = 0;
+  for (size_t n = 0; n < network::list.size(); n++)
+    hash += mix((networkHashes[n] = hashOf(*network::list[n].lastValues)) ^ mix(n));
+}
+void steadyState::rehash(size_t net)
+{
+  if (!enabled)
+    return;
+  hash -= mix(networkHashes[net] ^ mix(net));
+  hash += mix((networkHashes[net] = hashOf(*network::list[net].lastValues)) ^ mix(net));
+}
+void steadyState::takeSnapshot()
+{
+  snapshot.clear();
+  snapshotBegin.clear();
+  if (!enabled || network::simIndex == 0)
+    return;
+  for (network& net : network::list)
+  {
+    snapshotBegin.push_back(static_cast<uint32_t>(snapshot.size()));
+    net.lastValues->forEach([](size_t slot, int32_t value) { snapshot.push_back(uint64_t(slot) << 32 | static_cast<uint32_t>(value)); });
+  }
+  snapshotBegin.push_back(static_cast<uint32_t>(snapshot.size()));
+}
+bool steadyState::matchesSnapshot()
+{
+  if (snapshotBegin.size() != network::list.size() + 1)
+    return false;
+  bool matches = true;
+  for (size_t n = 0; n < network::list.size() && matches; n++)
+  {
+    size_t at = snapshotBegin[n];
+    network::list[n].lastValues->forEach([&](size_t slot, int32_t value)
+    {
+      matches = matches && at < snapshotBegin[n + 1] && snapshot[at++] == (uint64_t(slot) << 32 | static_cast<uint32_t>(value));
+    });
+    matches = matches && at == snapshotBegin[n + 1];
+  }
+  return matches;
+}
+void steadyState::advance(bool historyRecorded)
+{
+  tick++;
+  if (!historyRecorded || !enabled)
+    historyStart = tick;
+  if (!enabled)
+  {
+    period = 0;
+    return;
+  }
+  if (period != 0)
+  {
+    if ((tick - periodFoundAt) % period == 0 && hash != checkpoint)
+      reset();
+    return;
+  }
+  distance++;
+  if (hash == checkpoint && matchesSnapshot())
+  {
+    period = distance;
+    periodFoundAt = tick;
+  }
+  else if (distance == power)
+  {
+    checkpoint = hash;
+    takeSnapshot();
+    power *= 2;
+    distance = 0;
+  }
+}
+uint64_t steadyState::skip(uint64_t ticks)
+{
+  if (period == 0 || ticks == 0)
+    return 0;
+  size_t L = network::list.front().values.size();
+  if (period + 2 > L || tick - historyStart < period)
+  {
+    // the history doesn't hold a whole period, but its values are still valid after skipping whole periods
+    ticks -= ticks % period;
+  }
+  else
+  {
+    // rebuild the history from the last period, so that any tick can be jumped to
+    std::vector<signalValues> last;
+    for (network& net : network::list)
+    {
+      last.assign(net.values.begin(), net.values.end());
+      size_t latest = (network::simIndex + L - 2) % L;
+      for (size_t ticksAgo = 0; ticksAgo + 1 < L; ticksAgo++)
+        net.values[(latest + L - ticksAgo) % L] = last[(latest + L - (ticksAgo % period + period - ticks % period) % period) % L];
+    }
+    rehash();
+  }
+  tick += ticks;
+  periodFoundAt += ticks;
+  historyStart += ticks;
+  return ticks;
+}
+
+// wiring of an output relevant network in the blueprint, kept after compiling for analyses of the result
+struct compiledNetwork
+{
+  struct connection
+  {
+    pointer<entity> entity = -1;
+    connectionType index = connectionType::standard;
+  };
+  static thread_local std::vector<compiledNetwork> list;
+
+  size_t network; // index into network::list
+  color c;
+  enum : uint8_t {
+    none               = 0b0000,
+    isMainOutput       = 0b0001,
+    needsExtenderPoles = 0b0010
+  } flags;
+  std::vector<connection> connections; // maps into entities via first, bool true = input, false = output
+  std::vector<pointer<entity>> poles;  // that carry this network's wire
+};
+thread_local std::vector<compiledNetwork> compiledNetwork::list;
+
+// places the entities of compile() on a grid of slots that are one tile wide and two tall, whose rows leave a lane of tiles for poles
+// in between, so that designs become roughly square blueprints instead of a single row. The order of entityOrdering is laid out row
+// by row and then refined by simulated annealing, which swaps the contents of nearby slots to shorten the wires of the networks and to
+// keep them within reach. Bands of rows are annealed by separate threads, each seeing the other bands as they were at the start of a
+// round, so that the placement only depends on the seed and not on the number of threads
+struct placement
+{
+  struct slot
+  {
+    uint32_t x = 0, row = 0;
+  };
+  static bool enabled;          // places all entities in a single row when turned off
+  static uint64_t seed;
+  static size_t threads;        // 0 uses every hardware thread
+  static size_t movesPerEntity; // swaps tried per slot of the grid
+  static double reach;          // longest wire between the positions of two entities
+  static uint32_t constexpr rowPitch = 3;        // tiles from one row of slots to the next, the lowest of which is a lane for poles
+  static uint32_t constexpr annealedMembers = 64; // larger networks span much of the grid anyway and are left out of the annealing
+  static thread_local uint32_t width, rows;       // of the grid in slots
+  static thread_local uint64_t wireLengthBefore, wireLengthAfter; // summed half perimeters of the networks' bounding boxes in tiles
+
+  static std::vector<slot> run(std::vector<uint32_t> const& sources); // slot of every source, in the order that entityOrdering::run() returned
+  static std::tuple<float, float> positionOf(slot const& s, bool isDeciOrAri)
+  {
+    return { static_cast<float>(s.x), static_cast<float>(s.row * rowPitch) + (isDeciOrAri ? 1.5f : 2.0f) };
+  }
+};
+bool placement::enabled = true;
+uint64_t placement::seed = 0;
+size_t placement::threads = 0;
+size_t placement::movesPerEntity = 200;
+double placement::reach = 9;
+thread_local uint32_t placement::width = 0;
+thread_local uint32_t placement::rows = 0;
+thread_local uint64_t placement::wireLengthBefore = 0;
+thread_local uint64_t placement::wireLengthAfter = 0;
+
+// orders the entities of compile() along a row, which placement then folds into a grid, so that as few networks as possible span
+// more than the placement::reach tiles a wire reaches, since those need extender poles. Sources and networks form a hypergraph, which reverse Cuthill-McKee orders
+// component by component. Swaps of nearby entities then refine the better of that order and the order of network::source::list
+struct entityOrdering
+{
+  static bool enabled;
+  static size_t window; // how far apart two entities that a refining swap exchanges can be
+  static thread_local size_t wideBefore, wideAfter; // networks wider than a wire reaches in the order of network::source::list and in the chosen order
+
+  static std::vector<uint32_t> run(); // the output relevant sources in the order of their entities
+  // the nodes of every output relevant network and the networks of every node, as compressed sparse rows. nodeOf maps sources to nodes or none
+  static void hypergraph(std::vector<uint32_t> const& nodeOf, size_t nodes, graph::rows& members, graph::rows& netsOf);
+};
+bool entityOrdering::enabled = true;
+size_t entityOrdering::window = 8;
+thread_local size_t entityOrdering::wideBefore = 0;
+thread_local size_t entityOrdering::wideAfter = 0;
+
+std::vector<uint32_t> entityOrdering::run()
+{
+  std::vector<uint32_t> nodes; // output relevant sources
+  std::vector<uint32_t> nodeOf(network::source::list.size(), graph::none);
+  for (uint32_t s = 0; s < network::source::list.size(); s++)
+    if (network::source::list[s].flags & network::source::isOutputRelevant)
+    {
+      nodeOf[s] = static_cast<uint32_t>(nodes.size());
+      nodes.push_back(s);
+    }
+  wideBefore = wideAfter = 0;
+  if (!enabled || nodes.size() < 3)
+    return nodes;
+
+  graph::rows members, netsOf;
+  hypergraph(nodeOf, nodes.size(), members, netsOf);
+  size_t const nets = members.start.size() - 1;
+
+  // width of a network and how many are wider than a wire reaches, for positions of every node
+  uint32_t const reach = static_cast<uint32_t>(placement::reach);
+  auto width = [&members](uint32_t net, std::vector<uint32_t> const& position)
+  {
+    uint32_t min = UINT32_MAX, max = 0;
+    for (uint32_t node : members[net])
+    {
+      min = std::min(min, position[node]);
+      max = std::max(max, position[node]);
+    }
+    return max - min;
+  };
+  auto cost = [&](std::vector<uint32_t> const& position)
+  {
+    std::pair<size_t, uint64_t> result = { 0, 0 };
+    for (uint32_t net = 0; net < nets; net++)
+    {
+      uint32_t w = width(net, position);
+      result.first += w > reach;
+      result.second += w;
+    }
+    return result;
+  };
+  auto positionsOf = [&nodes](std::vector<uint32_t> const& order)
+  {
+    std::vector<uint32_t> position(nodes.size());
+    for (uint32_t i = 0; i < order.size(); i++)
+      position[order[i]] = i;
+    return position;
+  };
+
+  // reverse Cuthill-McKee, which expands the smaller networks of a node first and starts every component at a node that the
+  // breadth first search from its first node reaches last
+  std::vector<uint32_t> order;
+  std::vector<uint8_t> isVisited(nodes.size(), 0), isExpanded(nets, 0);
+  auto breadthFirst = [&](uint32_t start, std::vector<uint32_t>& visited)
+  {
+    visited.push_back(start);
+    isVisited[start] = 1;
+    for (size_t i = visited.size() - 1; i < visited.size(); i++)
+    {
+      std::vector<uint32_t> adjacent(netsOf[visited[i]].begin(), netsOf[visited[i]].end());
+      std::sort(adjacent.begin(), adjacent.end(), [&members](uint32_t l, uint32_t r) { return members[l].size() < members[r].size(); });
+      for (uint32_t net : adjacent)
+      {
+        if (isExpanded[net])
+          continue;
+        isExpanded[net] = 1;
+        size_t first = visited.size();
+        for (uint32_t node : members[net])
+          if (!isVisited[node])
+          {
+            isVisited[node] = 1;
+            visited.push_back(node);
+          }
+        std::stable_sort(visited.begin() + first, visited.end(), [&netsOf](uint32_t l, uint32_t r) { return netsOf[l].size() < netsOf[r].size(); });
+      }
+    }
+  };
+  for (uint32_t node = 0; node < nodes.size(); node++)
+    if (!isVisited[node])
+    {
+      std::vector<uint32_t> component;
+      breadthFirst(node, component);
+      for (uint32_t n : component)
+      {
+        isVisited[n] = 0;
+        for (uint32_t net : netsOf[n])
+          isExpanded[net] = 0;
+      }
+      std::vector<uint32_t> reversed;
+      breadthFirst(component.back(), reversed);
+      order.insert(order.end(), reversed.rbegin(), reversed.rend());
+    }
+
+  std::vector<uint32_t> sourceOrder(nodes.size());
+  for (uint32_t i = 0; i < nodes.size(); i++)
+    sourceOrder[i] = i;
+  std::vector<uint32_t> position = positionsOf(sourceOrder);
+  std::pair<size_t, uint64_t> before = cost(position);
+  wideBefore = before.first;
+  if (cost(positionsOf(order)) < before)
+    position = positionsOf(order);
+  else
+    order = sourceOrder;
+
+  // swaps of nearby nodes that make fewer networks wide or the small networks narrower. Networks of more nodes than fit within
+  // reach are always wide and left out, which keeps every swap cheap to evaluate
+  auto localCost = [&](uint32_t a, uint32_t b)
+  {
+    std::pair<size_t, uint64_t> result = { 0, 0 };
+    for (uint32_t node : { a, b })
+      for (uint32_t net : netsOf[node])
+        if (members[net].size() <= reach + 1 && (node == a || std::find(netsOf[a].begin(), netsOf[a].end(), net) == netsOf[a].end()))
+        {
+          uint32_t w = width(net, position);
+          result.first += w > reach;
+          result.second += w;
+        }
+    return result;
+  };
+  for (size_t pass = 0; pass < 4; pass++)
+  {
+    bool improved = false;
+    for (uint32_t i = 0; i < order.size(); i++)
+      for (uint32_t j = i + 1; j < order.size() && j <= i + window; j++)
+      {
+        uint32_t a = order[i], b = order[j];
+        std::pair<size_t, uint64_t> current = localCost(a, b);
+        std::swap(position[a], position[b]);
+        if (localCost(a, b) < current)
+        {
+          std::swap(order[i], order[j]);
+          improved = true;
+        }
+        else
+          std::swap(position[a], position[b]);
+      }
+    if (!improved)
+      break;
+  }
+  wideAfter = cost(position).first;
+
+  for (uint32_t& node : order)
+    node = nodes[node];
+  return order;
+}
+
+void entityOrdering::hypergraph(std::vector<uint32_t> const& nodeOf, size_t nodes, graph::rows& members, graph::rows& netsOf)
+{
+  members.start.assign(1, 0);
+  members.index.clear();
+  for (size_t n = 0; n < network::list.size(); n++)
+  {
+    if (!(network::list[n].flags & network::isOutputRelevant))
+      continue;
+    for (graph::rows const* adjacent : { &graph::writers, &graph::readers })
+      for (uint32_t s : (*adjacent)[n])
+        if (nodeOf[s] != graph::none)
+          members.index.push_back(nodeOf[s]);
+    std::sort(members.index.begin() + members.start.back(), members.index.end());
+    members.index.erase(std::unique(members.index.begin() + members.start.back(), members.index.end()), members.index.end());
+    members.start.push_back(static_cast<uint32_t>(members.index.size()));
+  }
+  netsOf.start.assign(nodes + 1, 0);
+  for (uint32_t node : members.index)
+    netsOf.start[node + 1]++;
+  for (size_t i = 0; i < nodes; i++)
+    netsOf.start[i + 1] += netsOf.start[i];
+  netsOf.index.resize(members.index.size());
+  std::vector<uint32_t> fill(netsOf.start.begin(), netsOf.start.end() - 1);
+  for (uint32_t net = 0; net + 1 < members.start.size(); net++)
+    for (uint32_t node : members[net])
+      netsOf.index[fill[node]++] = net;
+}
+
+std::vector<placement::slot> placement::run(std::vector<uint32_t> const& sources)
+{
+  uint32_t const n = static_cast<uint32_t>(sources.size());
+  std::vector<slot> result(n);
+  wireLengthBefore = wireLengthAfter = 0;
+  if (!enabled || n < 3)
+  {
+    width = n;
+    rows = n != 0;
+    for (uint32_t i = 0; i < n; i++)
+      result[i].x = i;
+    return result;
+  }
+  // an eighth of the slots stays empty, so that entities can move without swapping
+  // the workers have their own thread local width and rows, so they use gridWidth and gridRows
+  uint32_t const gridWidth = width = static_cast<uint32_t>(std::ceil(std::sqrt(rowPitch * n * 1.125)));
+  uint32_t const gridRows = rows = static_cast<uint32_t>(std::ceil(n * 1.125 / width));
+
+  std::vector<uint32_t> nodeOf(network::source::list.size(), graph::none);
+  for (uint32_t i = 0; i < n; i++)
+    nodeOf[sources[i]] = i;
+  graph::rows members, netsOf;
+  entityOrdering::hypergraph(nodeOf, n, members, netsOf);
+  size_t const nets = members.start.size() - 1;
+
+  // the order of entityOrdering row by row in alternating directions, with the empty slots spread over every row
+  uint32_t const perRow = (n + gridRows - 1) / gridRows;
+  std::vector<uint32_t> slotOf(n), nodeAt(gridWidth * gridRows, graph::none);
+  for (uint32_t i = 0; i < n; i++)
+  {
+    uint32_t row = i / perRow, x = static_cast<uint32_t>(uint64_t(i % perRow) * gridWidth / perRow);
+    slotOf[i] = row * gridWidth + (row % 2 == 0 ? x : gridWidth - 1 - x);
+    nodeAt[slotOf[i]] = i;
+  }
+
+  // main outputs also span to their posts right of the grid
+  std::vector<uint8_t> isMainOutput;
+  for (network const& net : network::list)
+    if (net.flags & network::isOutputRelevant)
+      isMainOutput.push_back((net.flags & network::isMainOutput) != 0);
+  // the slots of nodes in the rows [firstRow, endRow) are taken from current, those of all other nodes from start
+  auto extent = [&members, &isMainOutput, gridWidth](uint32_t net, std::vector<uint32_t> const& start, std::vector<uint32_t> const& current, uint32_t firstRow, uint32_t endRow)
+  {
+    uint32_t minX = UINT32_MAX, maxX = isMainOutput[net] ? gridWidth : 0, minRow = UINT32_MAX, maxRow = 0;
+    for (uint32_t node : members[net])
+    {
+      uint32_t s = start[node] / gridWidth >= firstRow && start[node] / gridWidth < endRow ? current[node] : start[node];
+      minX = std::min(minX, s % gridWidth);
+      maxX = std::max(maxX, s % gridWidth);
+      minRow = std::min(minRow, s / gridWidth);
+      maxRow = std::max(maxRow, s / gridWidth);
+    }
+    return std::make_tuple(double(maxX - minX), double(maxRow - minRow) * rowPitch);
+  };
+  auto cost = [&extent](uint32_t net, std::vector<uint32_t> const& start, std::vector<uint32_t> const& current, uint32_t firstRow, uint32_t endRow)
+  {
+    auto [dx, dy] = extent(net, start, current, firstRow, endRow);
+    return dx + dy + (dx * dx + dy * dy > reach * reach ? reach : 0);
+  };
+  auto wireLength = [&]()
+  {
+    uint64_t result = 0;
+    for (uint32_t net = 0; net < nets; net++)
+      if (members[net].size() != 0)
+      {
+        auto [dx, dy] = extent(net, slotOf, slotOf, 0, 0);
+        result += static_cast<uint64_t>(dx + dy);
+      }
+    return result;
+  };
+  wireLengthBefore = wireLength();
+
+  size_t const rounds = 32;
+  uint32_t const bands = std::max<uint32_t>(1, gridRows / 4);
+  size_t const workers = std::max<size_t>(1, std::min<size_t>(bands, threads != 0 ? threads : std::thread::hardware_concurrency()));
+  double const hottest = 1; // tiles of wire length that a swap may add with a chance of 1/e
+  std::vector<uint32_t> start;
+  for (size_t round = 0; round < rounds; round++)
+  {
+    // the temperature falls geometrically, the last two rounds only take swaps that make the placement better
+    double const temperature = round + 2 >= rounds ? 0 : hottest * std::pow(0.01, double(round) / (rounds - 3));
+    int64_t const xWindow = std::max<int64_t>(2, static_cast<int64_t>(gridWidth * temperature / hottest));
+    int64_t const rowWindow = std::max<int64_t>(1, static_cast<int64_t>(gridRows * temperature / hottest));
+    // the borders between the bands move by half a band every other round, so that nodes can cross them
+    uint32_t const shift = round % 2 == 1 ? gridRows / bands / 2 : 0;
+    auto border = [&](uint32_t band) { return band == 0 ? 0 : band == bands ? gridRows : band * gridRows / bands + shift; };
+    start = slotOf;
+
+    auto anneal = [&](uint32_t band)
+    {
+      uint32_t const firstRow = border(band), endRow = border(band + 1);
+      uint32_t const bandSlots = (endRow - firstRow) * gridWidth;
+      if (bandSlots < 2)
+        return;
+      uint64_t state = steadyState::mix(seed ^ steadyState::mix(round * bands + band));
+      auto random = [&state]() { return steadyState::mix(state++); };
+      std::vector<uint32_t> affected;
+      for (size_t move = movesPerEntity * bandSlots / rounds; move != 0; move--)
+      {
+        uint32_t a = firstRow * gridWidth + static_cast<uint32_t>(random() % bandSlots);
+        int64_t x = std::clamp<int64_t>(a % gridWidth + static_cast<int64_t>(random() % (2 * xWindow + 1)) - xWindow, 0, gridWidth - 1);
+        int64_t row = std::clamp<int64_t>(a / gridWidth + static_cast<int64_t>(random() % (2 * rowWindow + 1)) - rowWindow, firstRow, endRow - 1);
+        uint32_t b = static_cast<uint32_t>(row * gridWidth + x);
+        uint32_t nodeA = nodeAt[a], nodeB = nodeAt[b];
+        if (a == b || (nodeA == graph::none && nodeB == graph::none))
+          continue;
+        affected.clear();
+        for (uint32_t node : { nodeA, nodeB })
+          if (node != graph::none)
+            for (uint32_t net : netsOf[node])
+              if (members[net].size() <= annealedMembers)
+                affected.push_back(net);
+        std::sort(affected.begin(), affected.end());
+        affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+        double delta = 0;
+        for (uint32_t net : affected)
+          delta -= cost(net, start, slotOf, firstRow, endRow);
+        if (nodeA != graph::none)
+          slotOf[nodeA] = b;
+        if (nodeB != graph::none)
+          slotOf[nodeB] = a;
+        for (uint32_t net : affected)
+          delta += cost(net, start, slotOf, firstRow, endRow);
+        if (delta <= 0 || (temperature > 0 && (random() >> 11) * 0x1.0p-53 < std::exp(-delta / temperature)))
+          std::swap(nodeAt[a], nodeAt[b]);
+        else
+        {
+          if (nodeA != graph::none)
+            slotOf[nodeA] = a;
+          if (nodeB != graph::none)
+            slotOf[nodeB] = b;
+        }
+      }
+    };
+    // every band only writes the slots of its own rows and the nodes in them
+    std::atomic<uint32_t> nextBand = 0;
+    auto work = [&]()
+    {
+      for (uint32_t band; (band = nextBand.fetch_add(1)) < bands;)
+        anneal(band);
+    };
+    std::vector<std::thread> helpers;
+    for (size_t w = 1; w < workers; w++)
+      helpers.emplace_back(work);
+    work();
+    for (std::thread& t : helpers)
+      t.join();
+  }
+  wireLengthAfter = wireLength();
+
+  for (uint32_t i = 0; i < n; i++)
+    result[i] = { slotOf[i] % gridWidth, slotOf[i] / gridWidth };
+  return result;
+}
+
+// wires the placed entities of compile(). Every network grows a tree from its first connection like prim's algorithm, which attaches
+// the connection closest to any entity or pole of the tree next. Connections further away than a wire reaches are bridged by a chain
+// of poles, which later connections branch off from, so that the poles become the steiner points of the tree. Poles go onto every
+// tile that no combinator takes, each carries at most one network of each color, and a red and a green network share poles where
+// their chains pass by each other. Main outputs end at posts right of the grid
+struct routing
+{
+  static double shareBonus; // tiles of wire that reusing a pole of the other color is worth instead of placing a new one
+  static thread_local size_t poles, sharedPoles; // placed by the last compile(), and how many of them carry both colors
+
+  static void run();
+};
+double routing::shareBonus = 1;
+thread_local size_t routing::poles = 0;
+thread_local size_t routing::sharedPoles = 0;
+
+void routing::run()
+{
+  using connection = compiledNetwork::connection;
+  double const reach = placement::reach;
+  int64_t const outputX = placement::width + 1;
+  size_t const combinators = entity::list.size();
+  std::vector<std::array<uint32_t, 2>> carried; // network of each color on every pole, indexed by entity number - combinators
+  auto squaredDistance = [](std::tuple<float, float> const& l, std::tuple<float, float> const& r)
+  {
+    float dx = std::get<0>(l) - std::get<0>(r), dy = std::get<1>(l) - std::get<1>(r);
+    return double(dx * dx + dy * dy);
+  };
+  auto distance = [&squaredDistance](std::tuple<float, float> const& l, std::tuple<float, float> const& r) { return std::sqrt(squaredDistance(l, r)); };
+  auto connect = [](color c, connection const& l, connection const& r)
+  {
+    (*l.entity)(c, l.index).push_back({ r.entity, r.index });
+    (*r.entity)(c, r.index).push_back({ l.entity, l.index });
+  };
+  uint32_t const gridWidth = placement::width, gridHeight = placement::rows * placement::rowPitch;
+  std::vector<uint8_t> isTaken(size_t(gridWidth) * gridHeight, 0);
+  for (entity const& e : entity::list)
+  {
+    auto [x, y] = e.position;
+    isTaken[size_t(y) * gridWidth + size_t(x)] = 1;
+    if (e.source->flags & network::source::isDeciOrAri)
+      isTaken[size_t(y + 0.5f) * gridWidth + size_t(x)] = 1;
+  }
+  auto isCombinatorTile = [&](int64_t x, int64_t y) { return x < gridWidth && y < gridHeight && isTaken[size_t(y) * gridWidth + size_t(x)]; };
+  auto pole = [&](compiledNetwork& cnet, uint32_t net, int64_t x, int64_t y)
+  {
+    pointer<entity> result = poleAt(x, y);
+    carried.resize(entity::list.size() - combinators, { graph::none, graph::none });
+    carried[result.index - combinators][cnet.c != color::r] = net;
+    cnet.poles.push_back(result);
+    return connection{ result, connectionType::standard };
+  };
+  // lays poles from the connection from towards the position to until it is in reach, calls placed with every pole and returns the
+  // last of them, and whether it got there. Every pole goes onto the free tile in reach that is closest to to, or if the other networks
+  // of the color block the way, onto the closest tile that has no pole of this network yet
+  auto bridge = [&](compiledNetwork& cnet, uint32_t net, connection from, std::tuple<float, float> const to, auto const& placed)
+  {
+    for (double left = distance(from.entity->position, to); left > reach;)
+    {
+      setFlag(cnet.flags, compiledNetwork::needsExtenderPoles);
+      auto const [fx, fy] = from.entity->position;
+      int64_t closerX = -1, closerY = -1, detourX = -1, detourY = -1;
+      double closer = INFINITY, closerLeft = left, detour = INFINITY;
+      for (int64_t y = std::max<int64_t>(0, static_cast<int64_t>(std::ceil(fy - reach))); y <= fy + reach; y++)
+        for (int64_t x = std::max<int64_t>(0, static_cast<int64_t>(std::ceil(fx - reach))); x <= fx + reach; x++)
+        {
+          std::tuple<float, float> at = { static_cast<float>(x), static_cast<float>(y) };
+          if (isCombinatorTile(x, y) || distance({ fx, fy }, at) > reach)
+            continue;
+          pointer<entity> existing = entity::xyToPole.at(x, y);
+          std::array<uint32_t, 2> owners = existing ? carried[existing.index - combinators] : std::array<uint32_t, 2>{ graph::none, graph::none };
+          uint32_t owner = owners[cnet.c != color::r];
+          if (owner != graph::none && owner != net)
+            continue;
+          double d = distance(at, to);
+          if (d < left)
+          {
+            // the closest tile, unless reusing a pole of this network or the other color saves a new one
+            double score = d - (existing ? shareBonus : 0);
+            if (score < closer)
+            {
+              closer = score;
+              closerLeft = d;
+              closerX = x;
+              closerY = y;
+            }
+          }
+          else if (owner == graph::none && d < detour)
+          {
+            detour = d;
+            detourX = x;
+            detourY = y;
+          }
+        }
+      if (closerX == -1 && detourX == -1)
+        return std::make_tuple(from, false);
+      connection next = closerX != -1 ? pole(cnet, net, closerX, closerY) : pole(cnet, net, detourX, detourY);
+      connect(cnet.c, from, next);
+      placed(next);
+      from = next;
+      left = closerX != -1 ? closerLeft : detour;
+    }
+    return std::make_tuple(from, true);
+  };
+
+  std::vector<compiledNetwork>& cNetworks = compiledNetwork::list;
+  for (uint32_t net = 0; net < cNetworks.size(); net++)
+  {
+    compiledNetwork& cnet = cNetworks[net];
+    std::vector<connection> const& cons = cnet.connections;
+    // squared distance of every connection to the tree and the entity or pole of the tree it is closest to
+    std::vector<double> nearest(cons.size(), INFINITY);
+    std::vector<connection> via(cons.size());
+    std::vector<uint8_t> isInTree(cons.size(), 0);
+    auto reached = [&](connection const& node)
+    {
+      for (size_t j = 0; j < cons.size(); j++)
+        if (double d; !isInTree[j] && (d = squaredDistance(node.entity->position, cons[j].entity->position)) < nearest[j])
+        {
+          nearest[j] = d;
+          via[j] = node;
+        }
+    };
+    isInTree[0] = 1;
+    reached(cons[0]);
+    for (size_t i = 1; i < cons.size(); i++)
+    {
+      size_t next = 0;
+      for (size_t j = 1; j < cons.size(); j++)
+        if (!isInTree[j] && (isInTree[next] || nearest[j] < nearest[next]))
+          next = j;
+      isInTree[next] = 1;
+      if (nearest[next] <= reach * reach)
+        connect(cnet.c, via[next], cons[next]);
+      else
+      {
+        auto [last, isInReach] = bridge(cnet, net, via[next], cons[next].entity->position, reached);
+        if (!isInReach)
+          // every tile in reach of the chain is taken by combinators or by other networks of the color, and a longer wire would be invalid
+          throw std::runtime_error("Routing failed: no free tile for a pole within reach of a wire of network " + std::to_string(cnet.network) + ".");
+        connect(cnet.c, last, cons[next]);
+      }
+      reached(cons[next]);
+    }
+    if (cnet.flags & compiledNetwork::isMainOutput)
+    {
+      // from the rightmost entity or pole of the tree to the nearest free tile right of the grid, which the next rings around it are
+      // searched for. Outputs that other networks of the color block from getting there end at the last pole
+      connection rightmost = cons.front();
+      for (connection const& con : cons)
+        if (std::get<0>(con.entity->position) > std::get<0>(rightmost.entity->position))
+          rightmost = con;
+      for (pointer<entity> const& p : cnet.poles)
+        if (std::get<0>(p->position) > std::get<0>(rightmost.entity->position))
+          rightmost = { p, connectionType::standard };
+      std::tuple<float, float> const from = rightmost.entity->position;
+      int64_t const closestY = static_cast<int64_t>(std::get<1>(from));
+      int64_t x = -1, y = -1;
+      for (int64_t ring = 0; x == -1; ring++)
+        for (int64_t px = outputX; px <= outputX + ring; px++)
+          for (int64_t py = std::max<int64_t>(0, closestY - ring); py <= closestY + ring; py++)
+          {
+            pointer<entity> existing = entity::xyToPole.at(px, py);
+            if ((px == outputX + ring || py == closestY - ring || py == closestY + ring) && (!existing || carried[existing.index - combinators][cnet.c != color::r] == graph::none)
+              && (x == -1 || distance(from, { static_cast<float>(px), static_cast<float>(py) }) < distance(from, { static_cast<float>(x), static_cast<float>(y) })))
+            {
+              x = px;
+              y = py;
+            }
+          }
+      if (auto [last, isInReach] = bridge(cnet, net, rightmost, { static_cast<float>(x), static_cast<float>(y) }, [](connection const&) {}); isInReach)
+        if (connection post = pole(cnet, net, x, y); post.entity.index != last.entity.index)
+          connect(cnet.c, last, post);
+    }
+    std::sort(cnet.poles.begin(), cnet.poles.end(), [](pointer<entity> const& l, pointer<entity> const& r) { return l.index < r.index; });
+    cnet.poles.erase(std::unique(cnet.poles.begin(), cnet.poles.end(), [](pointer<entity> const& l, pointer<entity> const& r) { return l.index == r.index; }), cnet.poles.end());
+  }
+  poles = carried.size();
+  sharedPoles = 0;
+  for (std::array<uint32_t, 2> const& owners : carried)
+    sharedPoles += owners[0] != graph::none && owners[1] != graph::none;
+}
+
+// estimates what a compiled blueprint costs per tick ingame, from its entities, the wiring of its networks and how many signals the networks carried
+// while simulating, so that designs can be compared by their update cost instead of their combinator count
+// costs are in units of one decider or arithmetic combinator update without any signals, the weights are rough estimates that can be tuned
+struct upsCost
+{
+  struct weights
+  {
+    double combinator = 1.0;         // decider and arithmetic combinators are updated every tick
+    double constant = 0.0;           // constant combinators only change when edited
+    double perInputSignal = 0.05;    // signals a combinator reads from the sum of its input networks
+    double network = 0.5;            // every circuit network recomputes its signals every tick
+    double perNetworkSignal = 0.1;
+    double perConnection = 0.05;     // entities whose outputs are summed into the network
+    double pole = 0.05;              // poles hold the wires of the networks they carry, which are walked like any other connection
+  };
+  struct entry
+  {
+    size_t index;  // entity number for combinators, index into compiledNetwork::list for networks
+    double signals; // average input signals for combinators, average signals for networks
+    double cost;
+  };
+  struct result
+  {
+    std::vector<entry> combinators; // sorted by cost
+    std::vector<entry> networks;    // sorted by cost
+    size_t poles = 0;
+    double combinatorCost = 0, networkCost = 0, poleCost = 0, total = 0;
+    std::string report(size_t top = 20) const;
+    std::string json() const;
+  };
+
+  static thread_local bool recording;                   // samples the signal counts of all compiled networks every tick
+  static thread_local std::vector<uint64_t> signalTicks; // summed signal counts, indexed like compiledNetwork::list
+  static thread_local uint64_t samples;
+
+  static void sample();
+  static result estimate() { return estimate(weights()); }
+  static result estimate(weights const& w);
+};
+thread_local bool upsCost::recording = false;
+thread_local std::vector<uint64_t> upsCost::signalTicks;
+thread_local uint64_t upsCost::samples = 0;
+
+void upsCost::sample()
+{
+  signalTicks.resize(compiledNetwork::list.size(), 0);
+  for (size_t i = 0; i < compiledNetwork::list.size(); i++)
+    signalTicks[i] += network::list[compiledNetwork::list[i].network].lastValues->count();
+  samples++;
+}
+upsCost::result upsCost::estimate(weights const& w)
+{
+  assert(network::simIndex != 0 && "the circuit needs to be compiled before its cost can be estimated!");
+  result r;
+  // average signals per network in network::list, falling back to the current values if nothing was recorded
+  std::vector<double> signals(network::list.size(), 0);
+  for (size_t i = 0; i < compiledNetwork::list.size(); i++)
+  {
+    size_t n = compiledNetwork::list[i].network;
+    signals[n] = samples != 0 && i < signalTicks.size() ? double(signalTicks[i]) / samples : double(network::list[n].lastValues->count());
+  }
+  auto signalsOf = [&signals](pointer<network> const& net) { return net.index == -1 ? 0.0 : signals[graph::networkOf[net.index]]; };
+
+  for (entity const& e : entity::list)
+    if (e.source == nullptr)
+      r.poles++;
+    else if (e.source->flags & network::source::isConCom)
+      r.combinators.push_back({ e.entity_number.index + 1, 0, w.constant });
+    else
+    {
+      double in = signalsOf(e.source->redInput) + signalsOf(e.source->greenInput);
+      r.combinators.push_back({ e.entity_number.index + 1, in, w.combinator + w.perInputSignal * in });
+    }
+  for (size_t i = 0; i < compiledNetwork::list.size(); i++)
+  {
+    compiledNetwork const& cnet = compiledNetwork::list[i];
+    double s = signals[cnet.network];
+    size_t writers = 0;
+    for (compiledNetwork::connection const& con : cnet.connections)
+      writers += con.index != connectionType::input;
+    r.networks.push_back({ i, s, w.network + w.perNetworkSignal * s + w.perConnection * writers });
+  }
+  auto byCost = [](entry const& l, entry const& r) { return l.cost > r.cost; };
+  std::sort(r.combinators.begin(), r.combinators.end(), byCost);
+  std::sort(r.networks.begin(), r.networks.end(), byCost);
+  for (entry const& c : r.combinators)
+    r.combinatorCost += c.cost;
+  for (entry const& n : r.networks)
+    r.networkCost += n.cost;
+  r.poleCost = w.pole * r.poles;
+  r.total = r.combinatorCost + r.networkCost + r.poleCost;
+  return r;
+}
+std::string upsCost::result::report(size_t top) const
+{
+  std::ostringstream out;
+  out << "estimated cost per tick: " << this->total << " (combinators " << this->combinatorCost << ", networks " << this->networkCost << ", "
+      << this->poles << " poles " << this->poleCost << ")\n";
+  out << "most expensive combinators:\n";
+  for (size_t i = 0; i < this->combinators.size() && i < top; i++)
+    out << "  entity " << this->combinators[i].index << ": " << this->combinators[i].cost << " (" << this->combinators[i].signals << " input signals)\n";
+  out << "most expensive networks:\n";
+  for (size_t i = 0; i < this->networks.size() && i < top; i++)
+  {
+    compiledNetwork const& cnet = compiledNetwork::list[this->networks[i].index];
+    out << "  " << (cnet.c == color::r ? "red" : "green") << " network " << cnet.network << ": " << this->networks[i].cost << " (" << this->networks[i].signals
+        << " signals, " << cnet.connections.size() << " connections, " << cnet.poles.size() << " poles)\n";
+  }
+  return out.str();
+}
+std::string upsCost::result::json() const
+{
+  std::ostringstream out;
+  out << "{\"total\":" << this->total << ",\"combinatorCost\":" << this->combinatorCost << ",\"networkCost\":" << this->networkCost
+      << ",\"poles\":" << this->poles << ",\"poleCost\":" << this->poleCost << ",\"combinators\":{";
+  for (size_t i = 0; i < this->combinators.size(); i++)
+    out << (i == 0 ? "" : ",") << "\"" << this->combinators[i].index << "\":{\"inputSignals\":" << this->combinators[i].signals << ",\"cost\":" << this->combinators[i].cost << "}";
+  out << "},\"networks\":[";
+  for (size_t i = 0; i < this->networks.size(); i++)
+  {
+    compiledNetwork const& cnet = compiledNetwork::list[this->networks[i].index];
+    out << (i == 0 ? "" : ",") << "{\"network\":" << cnet.network << ",\"color\":\"" << (cnet.c == color::r ? "red" : "green") << "\",\"signals\":" << this->networks[i].signals
+        << ",\"connections\":" << cnet.connections.size() << ",\"poles\":" << cnet.poles.size() << ",\"cost\":" << this->networks[i].cost << "}";
+  }
+  out << "]}";
+  return out.str();
+}
+
+std::string compile(uint16_t lengthOfValueHistory)
+{
+  assert(lengthOfValueHistory >= 2 && "the value history needs to hold at least the last and the next tick!");
+  network::simIndex = 1;
+  network::compact();
+  graph::freeze();
+  network::lookupIndex = 0;
+  network::sourceIndex = 0;
+  for (network& net : network::list) 
+  {
+    net.values = std::vector<signalValues>(lengthOfValueHistory);
+    net.lastValues = &net.values[lengthOfValueHistory - 1];
+    net.nextValues = &net.values[network::simIndex - 1];
+  }
+  flagAllForOutput();
+  constantFolding::run();
+  combinatorFusion::run();
+  commonSubexpressions::run();
+  valueRanges::run();
+  steadyState::tick = steadyState::historyStart = 0;
+  steadyState::reset();
+  upsCost::signalTicks.clear();
+  upsCost::samples = 0;
+  std::vector<uint32_t> order = entityOrdering::run();
+  std::vector<placement::slot> slots = placement::run(order);
+  for (size_t i = 0; i < order.size(); i++)
+  {
+    network::source& source = network::source::list[order[i]];
+    entity next;
+    next.source = pointer<network::source>(order[i]);
+    source.entity = next.entity_number = entity::list.size();
+    next.position = placement::positionOf(slots[i], source.flags & network::source::isDeciOrAri);
+    if (source.flags & network::source::isDeciOrAri)
+    {
+      next.rConnection.emplace_back(std::vector<std::tuple<pointer<entity>, connectionType>>());
+      next.gConnection.emplace_back(std::vector<std::tuple<pointer<entity>, connectionType>>());
+    }
+    entity::list.emplace_back(next);
+  }
+  std::vector<compiledNetwork>& cNetworks = compiledNetwork::list;
+  cNetworks.clear();
+  for (size_t i = 0; i < network::list.size(); i++)
+    if (network const& net = network::list[i]; net.flags & network::isOutputRelevant)
+    {
+      compiledNetwork next;
+      next.network = i;
+      for (uint32_t s : graph::writers[i])
+        if (network::source const& source = network::source::list[s]; source.entity)
+          next.connections.push_back({ source.entity, source.flags & network::source::isDeciOrAri ? connectionType::output : connectionType::standard });
+      for (uint32_t s : graph::readers[i])
+        if (network::source const& target = network::source::list[s]; target.entity)
+          next.connections.push_back({ target.entity, connectionType::input });
+      next.c = net.c;
+      next.flags = net.flags & network::isMainOutput ? compiledNetwork::isMainOutput : compiledNetwork::none;
+      cNetworks.emplace_back(next);
+    }
+  routing::run();
+  liveness::run();
+  return stringify();
+}
+
+
+
+void rotateValueHistory(uint16_t lengthOfValueHistory)
+{
+  if (++network::simIndex > lengthOfValueHistory)
+    network::simIndex -= lengthOfValueHistory;
+  for(network& net : network::list)
+    //if (net.flags & network::isOutputRelevant)
+    {
+      if (net.flags & network::hasDeadSignals)
+        net.nextValues->keepOnly(net.live);
+      net.lastValues = net.nextValues;
+      net.nextValues = &net.values[network::simIndex - 1];
+      net.nextValues->clear();
+    }
+  network::lookupIndex = 0;
+  network::sourceIndex = 0;
+  steadyState::rehash();
+  steadyState::advance(true);
+  if (profiler::enabled)
+    profiler::recordTick();
+  if (upsCost::recording)
+    upsCost::sample();
+}
+
+std::string compileFirstOrSimulate(uint16_t lengthOfValueHistory)
+{
+  if (network::simIndex == 0)
+    return compile(lengthOfValueHistory);
+  else
+  {
+    rotateValueHistory(lengthOfValueHistory);
+    return "";
+  }
+}
+
+#define circuitState                                                                                                         \
+  x(network::list, networks) x(network::parent, parent) x(network::lookup, lookup)                                          \
+  x(network::simIndex, simIndex) x(network::lookupIndex, lookupIndex) x(network::sourceIndex, sourceIndex)                  \
+  x(network::source::list, sources) x(entity::list, entities) x(entity::xyToPole, xyToPole)                                 \
+  x(graph::writers, writers) x(graph::readers, readers) x(graph::outputs, outputs)                                         \
+  x(graph::red, red) x(graph::green, green) x(graph::networkOf, networkOf)                                                  \
+  x(profiler::enabled, profiling) x(profiler::sources, sourceStats) x(profiler::networks, networkStats)                     \
+  x(constantFolding::eliminated, eliminated) x(constantFolding::folded, folded)                                             \
+  x(combinatorFusion::saved, fusionSaved) x(combinatorFusion::fused, fused)                                                 \
+  x(commonSubexpressions::saved, subexpressionsSaved) x(commonSubexpressions::merged, merged)                               \
+  x(liveness::deadSignals, deadSignals) x(liveness::warnings, warnings)                                                     \
+  x(valueRanges::removed, removed) x(valueRanges::possible, possible) x(valueRanges::ranges, ranges)                        \
+  x(steadyState::tick, tick) x(steadyState::hash, hash) x(steadyState::period, period)                                      \
+  x(steadyState::periodFoundAt, periodFoundAt) x(steadyState::checkpoint, checkpoint) x(steadyState::power, power)          \
+  x(steadyState::distance, distance) x(steadyState::historyStart, historyStart) x(steadyState::networkHashes, networkHashes) \
+  x(steadyState::snapshot, snapshot) x(steadyState::snapshotBegin, snapshotBegin)                                           \
+  x(compiledNetwork::list, compiledNetworks) x(upsCost::recording, recording) x(upsCost::signalTicks, signalTicks)          \
+  x(upsCost::samples, samples) x(entityOrdering::wideBefore, wideBefore) x(entityOrdering::wideAfter, wideAfter)            \
+  x(placement::width, width) x(placement::rows, rows) x(placement::wireLengthBefore, wireLengthBefore)                      \
+  x(placement::wireLengthAfter, wireLengthAfter) x(routing::poles, poles) x(routing::sharedPoles, sharedPoles)
+
+struct circuit::state
+{
+#define x(variable, member) std::remove_reference_t<decltype(variable)> member = {};
+  circuitState
+#undef x
+};
+circuit::circuit() : data(std::make_unique<state>()) {}
+circuit::circuit(circuit&&) noexcept = default;
+circuit& circuit::operator=(circuit&&) noexcept = default;
+circuit::~circuit() = default;
+void circuit::bind()
+{
+  assert(this->data && "cannot bind a moved from circuit!");
+#define x(variable, member) std::swap(variable, this->data->member);
+  circuitState
+#undef x
+}
+#undef circuitState
+
+
+// flat instruction tape lowered from network::source::list, which simulates ticks without rerunning the circuit building code
+// every source becomes one instruction per network it writes into, grouped by that network
+struct program
+{
+  enum class opCode : uint8_t { constant, arithmetic, decider };
+  enum class operand : uint8_t { constant, signal, each, any, all };
+  struct instruction
+  {
+    opCode op;
+    operand left, right, output;
+    uint8_t mode;         // ariComData::Mode::Enum or deciComData::Mode::Enum
+    bool copyCount;       // decider outputs outputValue instead of the input count
+    uint32_t source;      // index into network::source::list
+    uint32_t red, green;  // indices into network::list, -1 if not connected
+    uint32_t out;         // index into network::list
+    int32_t leftValue;    // constant or slot, depending on left
+    int32_t rightValue;   // constant or slot, depending on right
+    uint32_t outputSlot;
+    int32_t outputValue;
+    uint32_t constantsBegin, constantsEnd; // range in constants for constant combinators
+  };
+  struct constant
+  {
+    uint32_t slot;
+    int32_t value;
+  };
+
+  std::vector<instruction> tape;
+  std::vector<constant> constants;
+  std::vector<uint32_t> writersBegin; // tape[writersBegin[n], writersBegin[n + 1]) writes into network::list[n]
+  std::vector<uint32_t> readersBegin; // readers[readersBegin[n], readersBegin[n + 1]) are the instructions of graph::readers[n]
+  std::vector<uint32_t> readers;
+  uint16_t lengthOfValueHistory = 0;
+  uint64_t tick = 0;
+
+  // event driven state, only valid while eventTick == tick
+  std::vector<signalValues> contributions; // last output of every instruction
+  std::vector<uint32_t> pending;           // instructions whose inputs changed during the last tick
+  std::vector<uint32_t> queue, touched;    // scratch lists of the instructions and networks of the current tick
+  std::vector<uint8_t> isQueued;           // set for the instructions in pending
+  std::vector<uint8_t> isTouched;          // set for the networks in touched
+  uint64_t eventTick = -1;
+
+  static program freeze();
+  void run(uint64_t ticks);
+  void runUntil(uint64_t targetTick); // skips whole periods once the circuit's state repeats, if steadyState::enabled
+  void runEventDriven(uint64_t ticks);
+  void runParallel(uint64_t ticks, size_t threads = std::thread::hardware_concurrency());
+  void execute(instruction const& i, signalValues& out) const;
+  void execute(instruction const& i, signalValues const* red, signalValues const* green, signalValues& out) const;
+};
+
+program program::freeze()
+{
+  assert(network::simIndex != 0 && "the circuit needs to be compiled before it can be frozen!");
+  program result;
+  result.lengthOfValueHistory = network::list.empty() ? 0 : static_cast<uint16_t>(network::list.front().values.size());
+  auto toSlot = [](signal const& s) { return static_cast<int32_t>(s.description->slot); };
+  for (size_t n = 0; n < network::list.size(); n++)
   {
-    if (++network::simIndex > lengthOfValueHistory)
-      network::simIndex -= lengthOfValueHistory;
-    for(network& net : network::list)
-      //if (net.flags & network::isOutputRelevant)
+    result.writersBegin.push_back(static_cast<uint32_t>(result.tape.size()));
+    for (uint32_t s : graph::writers[n])
+    {
+      network::source const& source = network::source::list[s];
+      instruction next = {};
+      next.source = s;
+      next.out = static_cast<uint32_t>(n);
+      next.red = next.green = uint32_t(-1);
+      switch (source.flags & (network::source::isDeciOrAri | network::source::isConCom))
+      {
+      case network::source::isConCom:
+        next.op = opCode::constant;
+        next.constantsBegin = static_cast<uint32_t>(result.constants.size());
+        for (auto const& osv : source.cCombinator)
+          if (osv.has_value())
+            result.constants.push_back({ static_cast<uint32_t>(osv.value().sig.description->slot), osv.value().value });
+        next.constantsEnd = static_cast<uint32_t>(result.constants.size());
+        break;
+      case network::source::isAriCom:
+      {
+        ariComData const& ari = source.aCombinator;
+        next.op = opCode::arithmetic;
+        next.red = graph::red[s];
+        next.green = graph::green[s];
+        next.mode = static_cast<uint8_t>(ari.mode.description->index);
+        std::visit(overload(
+          [&](int32_t const& i) { next.left = operand::constant; next.leftValue = i; },
+          [&](Each const&)      { next.left = operand::each; },
+          [&](signal const& s)  { next.left = operand::signal; next.leftValue = toSlot(s); }
+        ), ari.left);
+        std::visit(overload(
+          [&](int32_t const& i) { next.right = operand::constant; next.rightValue = i; },
+          [&](signal const& s)  { next.right = operand::signal; next.rightValue = toSlot(s); }
+        ), ari.right);
+        std::visit(overload(
+          [&](Each const&)     { next.output = operand::each; },
+          [&](signal const& s) { next.output = operand::signal; next.outputSlot = toSlot(s); }
+        ), ari.output);
+        assert((next.output != operand::each || next.left == operand::each) && "arithmetic combinator can't have each output without each input!");
+        break;
+      }
+      case network::source::isDeciCom:
       {
-        net.lastValues = net.nextValues;
-        net.nextValues = &net.values[network::simIndex - 1];
-        net.nextValues->clear();
+        deciComData const& deci = source.dCombinator;
+        next.op = opCode::decider;
+        next.red = graph::red[s];
+        next.green = graph::green[s];
+        next.mode = static_cast<uint8_t>(deci.mode.description->index);
+        std::visit(overload(
+          [&](Any const&)      { next.left = operand::any; },
+          [&](All const&)      { next.left = operand::all; },
+          [&](Each const&)     { next.left = operand::each; },
+          [&](signal const& s) { next.left = operand::signal; next.leftValue = toSlot(s); }
+        ), deci.left);
+        std::visit(overload(
+          [&](int32_t const& i) { next.right = operand::constant; next.rightValue = i; },
+          [&](signal const& s)  { next.right = operand::signal; next.rightValue = toSlot(s); }
+        ), deci.right);
+        std::visit(overload(
+          [&](All const&)      { next.output = operand::all; },
+          [&](Each const&)     { next.output = operand::each; },
+          [&](signal const& s) { next.output = operand::signal; next.outputSlot = toSlot(s); }
+        ), deci.output);
+        next.copyCount = deci.value.has_value();
+        next.outputValue = deci.value.value_or(0);
+        break;
       }
-    network::lookupIndex = 0;
-    return "";
+      }
+      network const& out = network::list[n];
+      if ((out.flags & network::hasDeadSignals) && next.output == operand::signal && !(out.live[next.outputSlot / 64] >> (next.outputSlot % 64) & 1))
+        continue; // only writes a signal that is dropped anyway
+      result.tape.push_back(next);
+    }
+  }
+  result.writersBegin.push_back(static_cast<uint32_t>(result.tape.size()));
+
+  std::vector<uint32_t> instructionsBegin(network::source::list.size() + 1, 0);
+  std::vector<uint32_t> instructionsOfSource(result.tape.size());
+  for (instruction const& i : result.tape)
+    instructionsBegin[i.source + 1]++;
+  for (size_t s = 1; s < instructionsBegin.size(); s++)
+    instructionsBegin[s] += instructionsBegin[s - 1];
+  std::vector<uint32_t> fill(instructionsBegin.begin(), instructionsBegin.end() - 1);
+  for (size_t t = 0; t < result.tape.size(); t++)
+    instructionsOfSource[fill[result.tape[t].source]++] = static_cast<uint32_t>(t);
+  for (size_t n = 0; n < network::list.size(); n++)
+  {
+    result.readersBegin.push_back(static_cast<uint32_t>(result.readers.size()));
+    for (uint32_t reader : graph::readers[n])
+      result.readers.insert(result.readers.end(), instructionsOfSource.begin() + instructionsBegin[reader], instructionsOfSource.begin() + instructionsBegin[reader + 1]);
+  }
+  result.readersBegin.push_back(static_cast<uint32_t>(result.readers.size()));
+  return result;
+}
+
+void program::execute(instruction const& i, signalValues& out) const
+{
+  this->execute(i, i.red == uint32_t(-1) ? nullptr : network::list[i.red].lastValues, i.green == uint32_t(-1) ? nullptr : network::list[i.green].lastValues, out);
+}
+void program::execute(instruction const& i, signalValues const* red, signalValues const* green, signalValues& out) const
+{
+  auto input = [red, green](int32_t slot) { return wrappingAdd(red ? (*red)[slot] : 0, green ? (*green)[slot] : 0); };
+
+  switch (i.op)
+  {
+  case opCode::constant:
+    for (uint32_t c = i.constantsBegin; c < i.constantsEnd; c++)
+      out.add(this->constants[c].slot, this->constants[c].value);
+    break;
+  case opCode::arithmetic:
+  {
+    auto mode = static_cast<ariComData::Mode::Enum>(i.mode);
+    int32_t rightNum = i.right == operand::constant ? i.rightValue : input(i.rightValue);
+    switch (i.left)
+    {
+    case operand::constant: out.add(i.outputSlot, calculate(mode, i.leftValue, rightNum)); break;
+    case operand::signal:   out.add(i.outputSlot, calculate(mode, input(i.leftValue), rightNum)); break;
+    case operand::each:
+      if (i.output == operand::each)
+        ariKernel(eachCalculate, mode, red, green, rightNum, out);
+      else
+        out.add(i.outputSlot, ariKernel(eachCalculateSum, mode, red, green, rightNum));
+      break;
+    default: assert(false && "invalid arithmetic combinator input!");
+    }
+    break;
+  }
+  case opCode::decider:
+  {
+    auto mode = static_cast<deciComData::Mode::Enum>(i.mode);
+    int32_t rightNum = i.right == operand::constant ? i.rightValue : input(i.rightValue);
+    bool result = false;
+    switch (i.left)
+    {
+    case operand::any:
+      result = deciKernel(decideAny, mode, red, green, rightNum);
+      break;
+    case operand::all:
+      result = deciKernel(decideAll, mode, red, green, rightNum);
+      break;
+    case operand::signal:
+      result = decide(mode, input(i.leftValue), rightNum);
+      break;
+    case operand::each:
+      if (i.output == operand::each)
+        deciKernel(eachDecide, mode, red, green, rightNum, i.copyCount, i.outputValue, out);
+      else
+        out.add(i.outputSlot, deciKernel(eachDecideSum, mode, red, green, rightNum, i.copyCount, i.outputValue));
+      break;
+    default: assert(false && "invalid decider combinator input!");
+    }
+    if (result)
+    {
+      if (i.output == operand::all)
+      {
+        if (i.copyCount)
+          forEachInput(red, green, [&](size_t slot, int32_t) { out.add(slot, i.outputValue); });
+        else
+          forEachInput(red, green, [&](size_t slot, int32_t value) { out.add(slot, value); });
+      }
+      else
+        out.add(i.outputSlot, i.copyCount ? i.outputValue : input(i.outputSlot));
+    }
+    break;
+  }
+  }
+}
+
+#undef ariKernel
+#undef deciKernel
+
+void program::run(uint64_t ticks)
+{
+  assert(network::lookupIndex == 0 && "programs can only be run in between ticks!");
+  for (; ticks != 0; ticks--, this->tick++)
+  {
+    for (instruction const& i : this->tape)
+      this->execute(i, *network::list[i.out].nextValues);
+    rotateValueHistory(this->lengthOfValueHistory);
+  }
+}
+
+void program::runUntil(uint64_t targetTick)
+{
+  while (this->tick < targetTick)
+  {
+    uint64_t skipped = steadyState::skip(targetTick - this->tick);
+    if (skipped != 0)
+      this->tick += skipped;
+    else
+      this->run(1);
+  }
+}
+
+// all threads wait until the last one arrives, which runs completion before releasing the others
+struct spinBarrier
+{
+  size_t const count;
+  std::atomic<size_t> waiting = 0;
+  std::atomic<size_t> generation = 0;
+
+  spinBarrier(size_t count) : count(count) {}
+  template<class F> void arriveAndWait(F const& completion)
+  {
+    size_t gen = this->generation.load(std::memory_order_acquire);
+    if (this->waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == this->count)
+    {
+      completion();
+      this->waiting.store(0, std::memory_order_relaxed);
+      this->generation.fetch_add(1, std::memory_order_release);
+    }
+    else
+      while (this->generation.load(std::memory_order_acquire) == gen)
+        std::this_thread::yield();
+  }
+};
+
+// every network is owned by the thread that evaluates all of its writers, so no two threads ever write into the same values
+// networks are grouped into chunks that threads take from their own range first and steal from other ranges afterwards
+// ticks address the value history by index instead of rotating it, which leaves a single barrier per tick
+void program::runParallel(uint64_t ticks, size_t threads)
+{
+  assert(network::lookupIndex == 0 && "programs can only be run in between ticks!");
+  threads = std::max<size_t>(threads, 1);
+  size_t const L = this->lengthOfValueHistory;
+  size_t const networks = network::list.size();
+  if (networks == 0 || ticks == 0)
+    return;
+
+  std::vector<uint32_t> chunksBegin; // networks [chunksBegin[c], chunksBegin[c + 1]) form chunk c
+  size_t const chunkCost = std::max<size_t>(1, (this->tape.size() + networks) / (threads * 16));
+  for (size_t n = 0, cost = chunkCost; n < networks; n++, cost++)
+  {
+    if (cost >= chunkCost)
+    {
+      chunksBegin.push_back(static_cast<uint32_t>(n));
+      cost = 0;
+    }
+    cost += this->writersBegin[n + 1] - this->writersBegin[n];
+  }
+  chunksBegin.push_back(static_cast<uint32_t>(networks));
+  size_t const chunks = chunksBegin.size() - 1;
+
+  struct alignas(64) range
+  {
+    std::atomic<size_t> next;
+    size_t begin, end;
+  };
+  std::vector<range> ranges(threads);
+  for (size_t w = 0; w < threads; w++)
+  {
+    ranges[w].begin = chunks * w / threads;
+    ranges[w].end = chunks * (w + 1) / threads;
+    ranges[w].next = ranges[w].begin;
+  }
+  spinBarrier barrier(threads);
+  size_t const firstSlot = network::simIndex - 1;
+  std::vector<network>& list = network::list; // of the circuit bound to this thread, the workers have none
+
+  auto work = [&](size_t w)
+  {
+    for (uint64_t tick = 0; tick < ticks; tick++)
+    {
+      size_t nextSlot = (firstSlot + tick) % L;
+      size_t lastSlot = (nextSlot + L - 1) % L;
+      for (size_t v = 0; v < threads; v++)
+      {
+        range& victim = ranges[(w + v) % threads];
+        for (size_t c; (c = victim.next.fetch_add(1, std::memory_order_relaxed)) < victim.end; )
+          for (uint32_t n = chunksBegin[c]; n < chunksBegin[c + 1]; n++)
+          {
+            signalValues& out = list[n].values[nextSlot];
+            out.clear();
+            for (uint32_t t = this->writersBegin[n]; t < this->writersBegin[n + 1]; t++)
+            {
+              instruction const& i = this->tape[t];
+              this->execute(i
+                , i.red == uint32_t(-1) ? nullptr : &list[i.red].values[lastSlot]
+                , i.green == uint32_t(-1) ? nullptr : &list[i.green].values[lastSlot]
+                , out);
+            }
+            if (list[n].flags & network::hasDeadSignals)
+              out.keepOnly(list[n].live);
+          }
+      }
+      barrier.arriveAndWait([&]()
+      {
+        for (range& r : ranges)
+          r.next.store(r.begin, std::memory_order_relaxed);
+      });
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t w = 1; w < threads; w++)
+    workers.emplace_back(work, w);
+  work(0);
+  for (std::thread& t : workers)
+    t.join();
+
+  network::simIndex = (firstSlot + ticks) % L + 1;
+  for (network& net : network::list)
+  {
+    net.lastValues = &net.values[(network::simIndex + L - 2) % L];
+    net.nextValues = &net.values[network::simIndex - 1];
+    net.nextValues->clear();
+  }
+  this->tick += ticks;
+  steadyState::tick += ticks;
+  steadyState::reset(); // the ticks in between haven't been hashed
+}
+
+// only reevaluates instructions whose inputs changed during the previous tick and only resums networks whose writers changed
+// lastValues is updated in place, so the value history isn't recorded while running event driven
+// this pays off when few networks change per tick, like counters that mostly wait for a carry or latches between their
+// set and reset ticks. Circuits that change most of their networks every tick, like clocks feeding every combinator,
+// run faster on the dense tape of run(). Calling it one tick at a time costs only the work of the changed networks
+void program::runEventDriven(uint64_t ticks)
+{
+  assert(network::lookupIndex == 0 && "programs can only be run in between ticks!");
+  if (this->eventTick != this->tick)
+  {
+    // (re)start from the current network values by evaluating everything once
+    this->contributions.assign(this->tape.size(), signalValues());
+    this->pending.resize(this->tape.size());
+    for (size_t t = 0; t < this->tape.size(); t++)
+      this->pending[t] = static_cast<uint32_t>(t);
+    this->isQueued.assign(this->tape.size(), 1);
+    this->isTouched.assign(network::list.size(), 1);
+    this->touched.clear();
+    for (size_t n = 0; n < network::list.size(); n++)
+      this->touched.push_back(static_cast<uint32_t>(n));
+  }
+  signalValues scratch;
+  for (; ticks != 0; ticks--, this->tick++)
+  {
+    std::swap(this->queue, this->pending);
+    this->pending.clear();
+    for (uint32_t t : this->queue)
+    {
+      this->isQueued[t] = 0;
+      scratch.clear();
+      this->execute(this->tape[t], scratch);
+      if (scratch != this->contributions[t])
+      {
+        std::swap(scratch, this->contributions[t]);
+        uint32_t n = this->tape[t].out;
+        if (!this->isTouched[n])
+        {
+          this->isTouched[n] = 1;
+          this->touched.push_back(n);
+        }
+      }
+    }
+    for (uint32_t n : this->touched)
+    {
+      this->isTouched[n] = 0;
+      scratch.clear();
+      for (uint32_t t = this->writersBegin[n]; t < this->writersBegin[n + 1]; t++)
+        scratch += this->contributions[t];
+      if (network::list[n].flags & network::hasDeadSignals)
+        scratch.keepOnly(network::list[n].live);
+      signalValues& current = *network::list[n].lastValues;
+      if (scratch != current)
+      {
+        std::swap(scratch, current);
+        steadyState::rehash(n);
+        for (uint32_t r = this->readersBegin[n]; r < this->readersBegin[n + 1]; r++)
+          if (!this->isQueued[this->readers[r]])
+          {
+            this->isQueued[this->readers[r]] = 1;
+            this->pending.push_back(this->readers[r]);
+          }
+      }
+    }
+    this->touched.clear();
+    steadyState::advance(false);
   }
+  this->eventTick = this->tick;
+}
+
+// calls f with a function object that computes the given mode, so that loops over it don't switch on the mode per element
+template<class F> void withMode(ariComData::Mode::Enum const& mode, F const& f)
+{
+  using E = ariComData::Mode::Enum;
+  switch (mode)
+  {
+  case E::multiplicaton: f([](int32_t l, int32_t r) { return calculate(E::multiplicaton, l, r); }); break;
+  case E::division:      f([](int32_t l, int32_t r) { return calculate(E::division,      l, r); }); break;
+  case E::addition:      f([](int32_t l, int32_t r) { return calculate(E::addition,      l, r); }); break;
+  case E::subtraction:   f([](int32_t l, int32_t r) { return calculate(E::subtraction,   l, r); }); break;
+  case E::modulo:        f([](int32_t l, int32_t r) { return calculate(E::modulo,        l, r); }); break;
+  case E::power:         f([](int32_t l, int32_t r) { return calculate(E::power,         l, r); }); break;
+  case E::shiftLeft:     f([](int32_t l, int32_t r) { return calculate(E::shiftLeft,     l, r); }); break;
+  case E::shiftRight:    f([](int32_t l, int32_t r) { return calculate(E::shiftRight,    l, r); }); break;
+  case E::bitAnd:        f([](int32_t l, int32_t r) { return calculate(E::bitAnd,        l, r); }); break;
+  case E::bitOr:         f([](int32_t l, int32_t r) { return calculate(E::bitOr,         l, r); }); break;
+  case E::bitXor:        f([](int32_t l, int32_t r) { return calculate(E::bitXor,        l, r); }); break;
+  }
+}
+template<class F> void withMode(deciComData::Mode::Enum const& mode, F const& f)
+{
+  using E = deciComData::Mode::Enum;
+  switch (mode)
+  {
+  case E::smaller:      f([](int32_t l, int32_t r) { return l <  r; }); break;
+  case E::greater:      f([](int32_t l, int32_t r) { return l >  r; }); break;
+  case E::equal:        f([](int32_t l, int32_t r) { return l == r; }); break;
+  case E::greaterEqual: f([](int32_t l, int32_t r) { return l >= r; }); break;
+  case E::smallerEqual: f([](int32_t l, int32_t r) { return l <= r; }); break;
+  case E::notEqual:     f([](int32_t l, int32_t r) { return l != r; }); break;
+  }
+}
+
+// runs independent copies of a frozen program in lockstep, one per lane
+// values are stored lane major, i.e. the values of all lanes for one (network, slot) pair are contiguous
+// lanes only differ by their stimuli, which act like constant combinators that only exist in one lane
+struct batch
+{
+  program const& prog;
+  size_t const lanes;
+  std::vector<int32_t> last, next;            // [network][slot][lane]
+  std::vector<uint64_t> lastPresent, nextPresent; // [network][word], set if the slot may be non zero in any lane
+  struct stimulus
+  {
+    uint32_t network;
+    uint32_t slot;
+    std::vector<int32_t> values; // [lane]
+  };
+  std::vector<stimulus> stimuli;
+  uint64_t tick = 0;
+
+  batch(program const& prog, size_t lanes);
+  template<color c> void set(wire<c> const& w, size_t lane, signal::WithValue const& sv) { this->set(w.source.source, lane, sv); }
+  void set(wire<color::rg> const& w, size_t lane, signal::WithValue const& sv) { this->set(w.r, lane, sv); this->set(w.g, lane, sv); }
+  template<color c> int32_t get(wire<c> const& w, size_t lane, signal const& s) const { return this->get(w.source.source, lane, s); }
+  void set(pointer<network> const& net, size_t lane, signal::WithValue const& sv);
+  int32_t get(pointer<network> const& net, size_t lane, signal const& s) const;
+  void run(uint64_t ticks);
+
+private:
+  size_t block(size_t net, size_t slot) const { return (net * signalValues::size + slot) * this->lanes; }
+  void execute(program::instruction const& i, int32_t* out, uint64_t* outPresent);
+  std::vector<int32_t> right, left, result, sum; // [lane] scratch
+};
+
+batch::batch(program const& prog, size_t lanes) 
+  : prog(prog), lanes(lanes)
+  , last(network::list.size() * signalValues::size * lanes, 0), next(last.size(), 0)
+  , lastPresent(network::list.size() * signalValues::words, 0), nextPresent(lastPresent.size(), 0)
+  , right(lanes), left(lanes), result(lanes), sum(lanes)
+{
+  assert(lanes > 0 && "a batch needs at least one lane!");
+  for (size_t n = 0; n < network::list.size(); n++)
+  {
+    signalValues const& current = *network::list[n].lastValues;
+    std::copy(current.present.begin(), current.present.end(), this->lastPresent.begin() + n * signalValues::words);
+    current.forEach([&](size_t slot, int32_t value) { std::fill_n(this->last.begin() + this->block(n, slot), lanes, value); });
+  }
+}
+
+void batch::set(pointer<network> const& net, size_t lane, signal::WithValue const& sv)
+{
+  assert(lane < this->lanes && "lane out of range!");
+  uint32_t n = graph::networkOf[net.index];
+  uint32_t slot = static_cast<uint32_t>(sv.sig.description->slot);
+  auto it = std::find_if(this->stimuli.begin(), this->stimuli.end(), [&](stimulus const& st) { return st.network == n && st.slot == slot; });
+  if (it == this->stimuli.end())
+    it = this->stimuli.insert(it, stimulus{ n, slot, std::vector<int32_t>(this->lanes, 0) });
+  it->values[lane] = sv.value;
+}
+
+int32_t batch::get(pointer<network> const& net, size_t lane, signal const& s) const
+{
+  assert(lane < this->lanes && "lane out of range!");
+  return this->last[this->block(graph::networkOf[net.index], s.description->slot) + lane];
+}
+
+void batch::run(uint64_t ticks)
+{
+  size_t const L = this->lanes;
+  for (; ticks != 0; ticks--, this->tick++)
+  {
+    for (size_t n = 0; n < network::list.size(); n++)
+    {
+      int32_t* out = &this->next[this->block(n, 0)];
+      uint64_t* outPresent = &this->nextPresent[n * signalValues::words];
+      for (size_t w = 0; w < signalValues::words; w++)
+        for (uint64_t bits = outPresent[w]; bits; bits &= bits - 1)
+          std::fill_n(out + (w * 64 + lowestBit(bits)) * L, L, 0);
+      std::fill_n(outPresent, signalValues::words, 0);
+      for (uint32_t t = this->prog.writersBegin[n]; t < this->prog.writersBegin[n + 1]; t++)
+        this->execute(this->prog.tape[t], out, outPresent);
+    }
+    for (stimulus const& st : this->stimuli)
+    {
+      int32_t* out = &this->next[this->block(st.network, st.slot)];
+      for (size_t l = 0; l < L; l++)
+        out[l] = wrappingAdd(out[l], st.values[l]);
+      this->nextPresent[st.network * signalValues::words + st.slot / 64] |= uint64_t(1) << (st.slot % 64);
+    }
+    std::swap(this->last, this->next);
+    std::swap(this->lastPresent, this->nextPresent);
+  }
+}
+
+void batch::execute(program::instruction const& i, int32_t* out, uint64_t* outPresent)
+{
+  using operand = program::operand;
+  size_t const L = this->lanes;
+  int32_t const* red = i.red == uint32_t(-1) ? nullptr : &this->last[this->block(i.red, 0)];
+  int32_t const* green = i.green == uint32_t(-1) ? nullptr : &this->last[this->block(i.green, 0)];
+  uint64_t const* redPresent = i.red == uint32_t(-1) ? nullptr : &this->lastPresent[i.red * signalValues::words];
+  uint64_t const* greenPresent = i.green == uint32_t(-1) ? nullptr : &this->lastPresent[i.green * signalValues::words];
+  int32_t* right = this->right.data();
+  int32_t* left = this->left.data();
+  int32_t* result = this->result.data();
+  int32_t* sum = this->sum.data();
+
+  auto mark = [outPresent](size_t slot) { outPresent[slot / 64] |= uint64_t(1) << (slot % 64); };
+  auto input = [&](size_t slot, int32_t* into)  // sum of both inputs for all lanes
+  {
+    int32_t const* r = red ? red + slot * L : nullptr;
+    int32_t const* g = green ? green + slot * L : nullptr;
+    if (r && g)
+      for (size_t l = 0; l < L; l++)
+        into[l] = wrappingAdd(r[l], g[l]);
+    else if (r || g)
+      std::copy_n(r ? r : g, L, into);
+    else
+      std::fill_n(into, L, 0);
+  };
+  auto forEachSlot = [&](auto const& f)  // calls f(slot) for every slot that may be non zero in any lane
+  {
+    for (size_t w = 0; w < signalValues::words; w++)
+      for (uint64_t bits = (redPresent ? redPresent[w] : 0) | (greenPresent ? greenPresent[w] : 0); bits; bits &= bits - 1)
+        f(w * 64 + lowestBit(bits));
+  };
+
+  switch (i.op)
+  {
+  case program::opCode::constant:
+    for (uint32_t c = i.constantsBegin; c < i.constantsEnd; c++)
+    {
+      int32_t* o = out + this->prog.constants[c].slot * L;
+      int32_t value = this->prog.constants[c].value;
+      for (size_t l = 0; l < L; l++)
+        o[l] = wrappingAdd(o[l], value);
+      mark(this->prog.constants[c].slot);
+    }
+    break;
+  case program::opCode::arithmetic:
+    if (i.right == operand::constant)
+      std::fill_n(right, L, i.rightValue);
+    else
+      input(i.rightValue, right);
+    withMode(static_cast<ariComData::Mode::Enum>(i.mode), [&](auto const& calc)
+    {
+      switch (i.left)
+      {
+      case operand::constant:
+      case operand::signal:
+      {
+        if (i.left == operand::constant)
+          std::fill_n(left, L, i.leftValue);
+        else
+          input(i.leftValue, left);
+        int32_t* o = out + i.outputSlot * L;
+        for (size_t l = 0; l < L; l++)
+          o[l] = wrappingAdd(o[l], calc(left[l], right[l]));
+        mark(i.outputSlot);
+        break;
+      }
+      case operand::each:
+        std::fill_n(sum, L, 0);
+        forEachSlot([&](size_t slot)
+        {
+          input(slot, left);
+          int32_t* o = i.output == operand::each ? out + slot * L : sum;
+          for (size_t l = 0; l < L; l++)
+            o[l] = wrappingAdd(o[l], left[l] != 0 ? calc(left[l], right[l]) : 0);
+          if (i.output == operand::each)
+            mark(slot);
+        });
+        if (i.output != operand::each)
+        {
+          int32_t* o = out + i.outputSlot * L;
+          for (size_t l = 0; l < L; l++)
+            o[l] = wrappingAdd(o[l], sum[l]);
+          mark(i.outputSlot);
+        }
+        break;
+      default: assert(false && "invalid arithmetic combinator input!");
+      }
+    });
+    break;
+  case program::opCode::decider:
+    if (i.right == operand::constant)
+      std::fill_n(right, L, i.rightValue);
+    else
+      input(i.rightValue, right);
+    withMode(static_cast<deciComData::Mode::Enum>(i.mode), [&](auto const& decide)
+    {
+      int32_t const copy = i.copyCount;
+      int32_t const value = i.outputValue;
+      switch (i.left)
+      {
+      case operand::any:
+        std::fill_n(result, L, 0);
+        forEachSlot([&](size_t slot)
+        {
+          input(slot, left);
+          for (size_t l = 0; l < L; l++)
+            result[l] |= left[l] != 0 && decide(left[l], right[l]);
+        });
+        break;
+      case operand::all:
+        std::fill_n(result, L, 1);
+        forEachSlot([&](size_t slot)
+        {
+          input(slot, left);
+          for (size_t l = 0; l < L; l++)
+            result[l] &= left[l] == 0 || decide(left[l], right[l]);
+        });
+        break;
+      case operand::signal:
+        input(i.leftValue, left);
+        for (size_t l = 0; l < L; l++)
+          result[l] = decide(left[l], right[l]);
+        break;
+      case operand::each:
+        std::fill_n(result, L, 0);
+        std::fill_n(sum, L, 0);
+        forEachSlot([&](size_t slot)
+        {
+          input(slot, left);
+          int32_t* o = i.output == operand::each ? out + slot * L : sum;
+          for (size_t l = 0; l < L; l++)
+            o[l] = wrappingAdd(o[l], left[l] != 0 && decide(left[l], right[l]) ? (copy ? value : left[l]) : 0);
+          if (i.output == operand::each)
+            mark(slot);
+        });
+        if (i.output != operand::each)
+        {
+          int32_t* o = out + i.outputSlot * L;
+          for (size_t l = 0; l < L; l++)
+            o[l] = wrappingAdd(o[l], sum[l]);
+          mark(i.outputSlot);
+        }
+        return;
+      default: assert(false && "invalid decider combinator input!");
+      }
+      if (i.output == operand::all)
+        forEachSlot([&](size_t slot)
+        {
+          input(slot, left);
+          int32_t* o = out + slot * L;
+          for (size_t l = 0; l < L; l++)
+            o[l] = wrappingAdd(o[l], result[l] && left[l] != 0 ? (copy ? value : left[l]) : 0);
+          mark(slot);
+        });
+      else
+      {
+        input(i.outputSlot, left);
+        int32_t* o = out + i.outputSlot * L;
+        for (size_t l = 0; l < L; l++)
+          o[l] = wrappingAdd(o[l], result[l] ? (copy ? value : left[l]) : 0);
+        mark(i.outputSlot);
+      }
+    });
+    break;
+  }
+}
+
+// second backend next to compile(), which turns the output relevant part of a compiled circuit into a standalone c++ source file
+// every (network, signal) pair that can ever be non zero becomes one variable, found by propagating signals through the combinators until nothing changes,
+// so that each tick becomes a single straight-line function with all modes, signals and constants specialized in
+std::string emitKernel(std::string const& name)
+{
+  assert(network::simIndex != 0 && "the circuit needs to be compiled before a kernel can be emitted!");
+  using bits = std::array<uint64_t, signalValues::words>;
+  using operand = program::operand;
+  program prog = program::freeze();
+  std::vector<program::instruction> tape;
+  for (program::instruction const& i : prog.tape)
+    if (network::source::list[i.source].flags & network::source::isOutputRelevant)
+      tape.push_back(i);
+
+  std::vector<bits> present(network::list.size(), bits{});
+  auto has = [&](uint32_t net, size_t slot) { return net != uint32_t(-1) && (present[net][slot / 64] >> (slot % 64) & 1); };
+  for (bool changed = true; changed; )
+  {
+    changed = false;
+    for (program::instruction const& i : tape)
+    {
+      bits next = present[i.out];
+      auto set = [&](size_t slot) { next[slot / 64] |= uint64_t(1) << (slot % 64); };
+      if (i.op == program::opCode::constant)
+        for (uint32_t c = i.constantsBegin; c < i.constantsEnd; c++)
+          set(prog.constants[c].slot);
+      else if (i.output == operand::each || i.output == operand::all)
+        for (size_t w = 0; w < signalValues::words; w++)
+          next[w] |= (i.red != uint32_t(-1) ? present[i.red][w] : 0) | (i.green != uint32_t(-1) ? present[i.green][w] : 0);
+      else
+        set(i.outputSlot);
+      if (next != present[i.out])
+      {
+        present[i.out] = next;
+        changed = true;
+      }
+    }
+  }
+  std::vector<std::vector<uint32_t>> variable(network::list.size());
+  std::ostringstream variables;
+  size_t size = 0;
+  for (size_t n = 0; n < network::list.size(); n++)
+    for (size_t slot = 0; slot < signalValues::size; slot++)
+      if (has(static_cast<uint32_t>(n), slot))
+      {
+        variable[n].resize(signalValues::size, uint32_t(-1));
+        variable[n][slot] = static_cast<uint32_t>(size++);
+        variables << "  { " << n << ", \"" << signalValues::signalAt(slot).description->gameSyntax << "\" },\n";
+      }
+
+  // the input of an instruction as an expression of the last tick's variables
+  auto input = [&](program::instruction const& i, size_t slot)
+  {
+    std::string red = has(i.red, slot) ? "l[" + std::to_string(variable[i.red][slot]) + "]" : "";
+    std::string green = has(i.green, slot) ? "l[" + std::to_string(variable[i.green][slot]) + "]" : "";
+    return red.empty() ? (green.empty() ? std::string("0") : green) : (green.empty() ? red : "add(" + red + ", " + green + ")");
+  };
+  auto inputSlots = [&](program::instruction const& i)
+  {
+    std::vector<size_t> slots;
+    for (size_t slot = 0; slot < signalValues::size; slot++)
+      if (has(i.red, slot) || has(i.green, slot))
+        slots.push_back(slot);
+    return slots;
+  };
+  auto calculation = [](uint8_t mode, std::string const& left, std::string const& right)
+  {
+    static char const* const functions[] = { "mul", "div", "add", "sub", "mod", "pow", "shl", "shr", "bitAnd", "bitOr", "bitXor" };
+    return std::string(functions[mode]) + "(" + left + ", " + right + ")";
+  };
+  auto decision = [](uint8_t mode, std::string const& left, std::string const& right)
+  {
+    static char const* const operators[] = { " < ", " > ", " == ", " >= ", " <= ", " != " };
+    return "(" + left + operators[mode] + right + ")";
+  };
+
+  std::vector<int32_t> initial(size, 0); // constant combinators are summed into the initial value of every tick
+  std::ostringstream body;
+  for (program::instruction const& i : tape)
+  {
+    auto out = [&](size_t slot) { return "n[" + std::to_string(variable[i.out][slot]) + "]"; };
+    auto accumulate = [&](size_t slot, std::string const& value) { body << "  " << out(slot) << " = add(" << out(slot) << ", " << value << ");\n"; };
+    std::string right = i.right == operand::constant ? std::to_string(i.rightValue) : input(i, i.rightValue);
+    switch (i.op)
+    {
+    case program::opCode::constant:
+      for (uint32_t c = i.constantsBegin; c < i.constantsEnd; c++)
+      {
+        int32_t& v = initial[variable[i.out][prog.constants[c].slot]];
+        v = wrappingAdd(v, prog.constants[c].value);
+      }
+      break;
+    case program::opCode::arithmetic:
+      if (i.left == operand::constant && i.right == operand::constant)
+      {
+        int32_t& v = initial[variable[i.out][i.outputSlot]];
+        v = wrappingAdd(v, calculate(static_cast<ariComData::Mode::Enum>(i.mode), i.leftValue, i.rightValue));
+      }
+      else if (i.left != operand::each)
+        accumulate(i.outputSlot, calculation(i.mode, i.left == operand::constant ? std::to_string(i.leftValue) : input(i, i.leftValue), right));
+      else
+      {
+        body << "  {\n    int32_t r = " << right << ", x = 0, s = 0;\n";
+        for (size_t slot : inputSlots(i))
+          if (i.output == operand::each)
+            body << "    x = " << input(i, slot) << "; " << out(slot) << " = add(" << out(slot) << ", x ? " << calculation(i.mode, "x", "r") << " : 0);\n";
+          else
+            body << "    x = " << input(i, slot) << "; s = add(s, x ? " << calculation(i.mode, "x", "r") << " : 0);\n";
+        if (i.output != operand::each)
+          body << "    " << out(i.outputSlot) << " = add(" << out(i.outputSlot) << ", s);\n";
+        body << "    (void)x;\n    (void)s;\n  }\n";
+      }
+      break;
+    case program::opCode::decider:
+    {
+      std::string value = std::to_string(i.outputValue);
+      std::vector<size_t> slots = inputSlots(i);
+      body << "  {\n    int32_t r = " << right << ", x = 0, s = 0;\n";
+      if (i.left == operand::each)
+      {
+        for (size_t slot : slots)
+          if (i.output == operand::each)
+            body << "    x = " << input(i, slot) << "; if (x && " << decision(i.mode, "x", "r") << ") " << out(slot) << " = add(" << out(slot) << ", " << (i.copyCount ? value : "x") << ");\n";
+          else
+            body << "    x = " << input(i, slot) << "; if (x && " << decision(i.mode, "x", "r") << ") s = add(s, " << (i.copyCount ? value : "x") << ");\n";
+        if (i.output != operand::each)
+          body << "    " << out(i.outputSlot) << " = add(" << out(i.outputSlot) << ", s);\n";
+        body << "    (void)x;\n    (void)s;\n  }\n";
+        break;
+      }
+      if (i.left == operand::signal)
+        body << "    bool t = " << decision(i.mode, input(i, i.leftValue), "r") << ";\n";
+      else
+      {
+        body << "    bool t = " << (i.left == operand::all ? "true" : "false") << ";\n";
+        for (size_t slot : slots)
+          body << "    x = " << input(i, slot) << "; t = t " << (i.left == operand::any ? "|| (x && " : "&& (!x || ") << decision(i.mode, "x", "r") << ");\n";
+      }
+      body << "    (void)s;\n    if (t)\n    {\n";
+      if (i.output == operand::all)
+        for (size_t slot : slots)
+          body << "      x = " << input(i, slot) << "; " << out(slot) << " = add(" << out(slot) << ", x ? " << (i.copyCount ? value : "x") << " : 0);\n";
+      else
+        body << "      " << out(i.outputSlot) << " = add(" << out(i.outputSlot) << ", " << (i.copyCount ? value : input(i, i.outputSlot)) << ");\n";
+      body << "    }\n    (void)x;\n  }\n";
+      break;
+    }
+    }
+  }
+
+  std::ostringstream out;
+  out << "// generated by combiler, simulates " << tape.size() << " combinator outputs on " << size << " (network, signal) values without interpretation\n"
+      << "#pragma once\n#include <cstdint>\n#include <cstddef>\n#include <climits>\n#include <cstring>\n#include <utility>\n#include <vector>\n\n"
+      << "namespace " << name << "\n{\n"
+      << "using std::int32_t;\nusing std::uint32_t;\n"
+      << "std::size_t constexpr size = " << size << ";\n"
+      << "struct variable\n{\n  uint32_t network; // index into network::list when the kernel was emitted\n  char const* signal;\n};\n"
+      << "variable const variables[size + 1] = {\n" << variables.str() << "  { 0, nullptr }\n};\n\n"
+      << "// ingame arithmetic, which wraps around on overflow and results in 0 where c++ would be undefined\n"
+      << "inline int32_t add(int32_t a, int32_t b)    { return static_cast<int32_t>(static_cast<uint32_t>(a) + static_cast<uint32_t>(b)); }\n"
+      << "inline int32_t sub(int32_t a, int32_t b)    { return static_cast<int32_t>(static_cast<uint32_t>(a) - static_cast<uint32_t>(b)); }\n"
+      << "inline int32_t mul(int32_t a, int32_t b)    { return static_cast<int32_t>(static_cast<uint32_t>(a) * static_cast<uint32_t>(b)); }\n"
+      << "inline int32_t div(int32_t a, int32_t b)    { return b == 0 || (b == -1 && a == INT32_MIN) ? 0 : a / b; }\n"
+      << "inline int32_t mod(int32_t a, int32_t b)    { return b == 0 || (b == -1 && a == INT32_MIN) ? 0 : a % b; }\n"
+      << "inline int32_t shl(int32_t a, int32_t b)    { return static_cast<int32_t>(static_cast<uint32_t>(a) << (b & 31)); }\n"
+      << "inline int32_t shr(int32_t a, int32_t b)    { return a >> (b & 31); }\n"
+      << "inline int32_t bitAnd(int32_t a, int32_t b) { return a & b; }\n"
+      << "inline int32_t bitOr(int32_t a, int32_t b)  { return a | b; }\n"
+      << "inline int32_t bitXor(int32_t a, int32_t b) { return a ^ b; }\n"
+      << "inline int32_t pow(int32_t a, int32_t b)\n{\n"
+      << "  if (b == 0 || a == 1) return 1;\n  if (a == -1) return b & 1 ? -1 : 1;\n  if (a == 0 || b < 0) return 0;\n"
+      << "  uint32_t result = 1;\n  for (uint32_t y = static_cast<uint32_t>(a); b; y *= y, b >>= 1)\n    if (b & 1)\n      result *= y;\n"
+      << "  return static_cast<int32_t>(result);\n}\n\n"
+      << "// computes the next tick n from the last tick l\n"
+      << "inline void tick(int32_t const* l, int32_t* n)\n{\n  (void)l;\n";
+  for (size_t v = 0; v < size; v++)
+    out << "  n[" << v << "] = " << initial[v] << ";\n";
+  out << body.str() << "}\n\n"
+      << "// simulates the given number of ticks, starting from and ending in values, scratch holds the other tick and size + 1 values like values\n"
+      << "inline void run(int32_t* values, int32_t* scratch, std::uint64_t ticks)\n{\n"
+      << "  int32_t* l = values;\n  int32_t* n = scratch;\n"
+      << "  for (; ticks != 0; ticks--)\n  {\n    tick(l, n);\n    std::swap(l, n);\n  }\n"
+      << "  if (l != values)\n    std::memcpy(values, l, sizeof(int32_t) * size);\n}\n"
+      << "// allocates the scratch on the heap, because large circuits would overflow the stack\n"
+      << "inline void run(int32_t* values, std::uint64_t ticks)\n{\n"
+      << "  std::vector<int32_t> scratch(size + 1);\n  run(values, scratch.data(), ticks);\n}\n"
+      << "}\n";
+  return out.str();
 }
 
 #endif